@@ -0,0 +1,24 @@
+#!/bin/sh
+# Compare the BSP backend with the shared-memory backend on the same graphs.
+#
+# Usage: ./benchmark.sh <binary> <cores> [graph files...]
+#
+# Without graph files, every input in testcases/ is used.
+# Prints a CSV line with the matching size and duration for every run.
+
+BINARY=$1
+CORES=$2
+shift 2
+
+if [ $# -eq 0 ]; then
+    set -- testcases/*.input
+fi
+
+echo "graph,backend,cores,matches,seconds"
+
+for GRAPH in "$@"; do
+    for BACKEND in bsp shared; do
+        "$BINARY" -p "$CORES" -b "$BACKEND" < "$GRAPH" \
+            | sed -n "s/^Found a matching of \([0-9]*\) edges in \([0-9.]*\) seconds.$/$(basename "$GRAPH"),$BACKEND,$CORES,\1,\2/p"
+    done
+done
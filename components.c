@@ -0,0 +1,573 @@
+#include "components.h"
+#include "graph.h"
+#include "instructions.h"
+#include "match.h"
+#include "sequential.h"
+#include "stats.h"
+#include "utilities.h"
+
+// PRIVATE FUNCTIONS
+void label_components(struct graph *g);
+nid_int find_root(nid_int *parent, nid_int i);
+nid_int *judge_components(struct graph *g, nid_int *labels, 
+                          nid_int labels_length);
+nid_int (*gather_small_components(struct graph *g, nid_int *labels, 
+                                  nid_int labels_length, nid_int *targets,
+                                  nid_int *edges_length))[2];
+void prune_small_components(struct graph *g, nid_int *labels, 
+                            nid_int labels_length, nid_int *targets);
+void report_small_components(struct graph *g, nid_int *labels, 
+                             nid_int labels_length, nid_int *targets);
+
+/**
+ * Match all small connected components without distributed communication.
+ *
+ * The connected components of the graph are found locally with a union-find,
+ * after which their labels are exchanged across processes. Every component
+ * with at most `SMALL_COMPONENT_SIZE` vertices is gathered on a single
+ * process and matched there. Vertices of these components are removed from
+ * the graph, so that only the large components go through the distributed
+ * supersteps.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ */
+void solve_small_components(struct graph *g) {
+    // The steps below expect a node in every entry of the vertex array.
+    compact_graph(g);
+    label_components(g);
+
+    // Collect the labels of all components in this process.
+    nid_int *labels        = malloc(g->local_degree * sizeof(nid_int));
+    nid_int  labels_length = 0;
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        labels[i] = g->vertex[i]->component;
+    }
+    qsort(labels, g->local_degree, sizeof(nid_int), compare_nids);
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        if (labels_length == 0 || labels[labels_length-1] != labels[i]) {
+            labels[labels_length] = labels[i];
+            labels_length++;
+        }
+    }
+
+    nid_int *targets = judge_components(g, labels, labels_length);
+
+    nid_int edges_length;
+    nid_int (*edges)[2] = gather_small_components(g, labels, labels_length, 
+                                                  targets, &edges_length);
+
+    report_small_components(g, labels, labels_length, targets);
+
+    // The heuristic may choose an arbitrary edge, so none of its matches are
+    // known to be in a maximum matching.
+    nid_int before = g->m->length;
+    match_sequential(edges, edges_length, g->m);
+    g->guessed = g->guessed + (g->m->length - before);
+
+    prune_small_components(g, labels, labels_length, targets);
+
+    free(edges);
+    free(targets);
+    free(labels);
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Label every vertex with the smallest node identifier in its component.
+ *
+ * The components within this process are found first with a union-find over
+ * the local vertex indices, which visits every edge once. Only the labels of
+ * vertices with neighbours in other processes are exchanged afterwards: every
+ * superstep, the local components whose label went down send it across their
+ * edges to other processes. This repeats until no label changes anymore.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ */
+void label_components(struct graph *g) {
+    nid_int  local_degree = g->local_degree;
+    nid_int *parent       = malloc((local_degree + 1) * sizeof(nid_int));
+    nid_int *label        = malloc((local_degree + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<local_degree; i++) {
+        parent[i] = i;
+    }
+
+    // Join the local edges, and count the edges to other processes.
+    nid_int boundary_length = 0;
+
+    for (nid_int i=0; i<local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        compact_edges(nd);
+
+        for (nid_int j=0; j<nd->degree; j++) {
+            nid_int neighbour = nd->connections[j];
+
+            if (!belongs_here(g, neighbour)) {
+                boundary_length++;
+                continue;
+            }
+
+            // Every local edge is seen from both sides, so join it once.
+            if (neighbour < nd->value) {
+                continue;
+            }
+
+            nid_int k = search_sorted(g->values, local_degree, neighbour);
+            if (k == local_degree) {
+                continue;
+            }
+
+            // The smallest index becomes the root, which is also the node
+            // with the smallest identifier, as the vertex array is sorted.
+            nid_int a = find_root(parent, i);
+            nid_int b = find_root(parent, k);
+
+            if (a < b) {
+                parent[b] = a;
+            } else {
+                parent[a] = b;
+            }
+        }
+    }
+
+    // Group the edges to other processes by the root of their local vertex.
+    nid_int *first  = calloc(local_degree + 2, sizeof(nid_int));
+    nid_int *remote = malloc((boundary_length + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        nid_int      r  = find_root(parent, i);
+
+        label[i] = g->values[i];
+
+        for (nid_int j=0; j<nd->degree; j++) {
+            if (!belongs_here(g, nd->connections[j])) {
+                first[r+2]++;
+            }
+        }
+    }
+    for (nid_int r=0; r<local_degree; r++) {
+        first[r+2] = first[r+2] + first[r+1];
+    }
+    for (nid_int i=0; i<local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        nid_int      r  = find_root(parent, i);
+
+        for (nid_int j=0; j<nd->degree; j++) {
+            if (!belongs_here(g, nd->connections[j])) {
+                remote[first[r+1]] = nd->connections[j];
+                first[r+1]++;
+            }
+        }
+    }
+
+    // Every root with edges to other processes starts with a fresh label.
+    nid_int *changed        = malloc((local_degree + 1) * sizeof(nid_int));
+    bool    *queued         = calloc(local_degree + 1, sizeof(bool));
+    nid_int  changed_length = 0;
+
+    for (nid_int r=0; r<local_degree; r++) {
+        if (first[r+1] > first[r]) {
+            changed[changed_length] = r;
+            queued[r]               = true;
+            changed_length++;
+        }
+    }
+
+    struct todo_list *todo;
+    struct instruction *response;
+
+    while (true) {
+        todo = get_todo_list();
+
+        for (nid_int k=0; k<changed_length; k++) {
+            nid_int r = changed[k];
+            queued[r] = false;
+
+            for (nid_int j=first[r]; j<first[r+1]; j++) {
+                add_instruction(
+                    instruction_component_label(remote[j], label[r]),
+                    todo, belongs_to_proc(g, remote[j])
+                );
+            }
+        }
+        changed_length = 0;
+
+        response = send_instructions(todo);
+
+        if (todo->expected_responses == 0) {
+            unallocate_todo_list(todo);
+            free(response);
+
+            break;
+        }
+
+        for (nid_int i=0; i<todo->expected_responses; i++) {
+            nid_int index;
+
+            if (response[i].value != COMPONENT_LABEL ||
+                index_of_node(g, response[i].content[0], &index) != 1) {
+                continue;
+            }
+
+            nid_int r = find_root(parent, index);
+
+            if (label[r] > response[i].content[1]) {
+                label[r] = response[i].content[1];
+
+                if (!queued[r]) {
+                    changed[changed_length] = r;
+                    queued[r]               = true;
+                    changed_length++;
+                }
+            }
+        }
+
+        unallocate_todo_list(todo);
+        free(response);
+    }
+
+    for (nid_int i=0; i<local_degree; i++) {
+        g->vertex[i]->component = label[find_root(parent, i)];
+    }
+
+    free(parent);
+    free(label);
+    free(first);
+    free(remote);
+    free(changed);
+    free(queued);
+}
+
+/** PRIVATE
+ * Find the root of a vertex in a union-find forest, and halve the path to it
+ * along the way.
+ *
+ * Parameters:
+ * - `parent`   Parent of every local vertex index. Roots are their own parent.
+ * - `i`        Local vertex index.
+ *
+ * Returns:     Local vertex index of the root.
+ */
+nid_int find_root(nid_int *parent, nid_int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i         = parent[i];
+    }
+
+    return i;
+}
+
+/** PRIVATE
+ * Decide for every component whether it is small, and which process solves it.
+ *
+ * Every process reports the size of its part of each component to the process
+ * of the component's root, which is the node that the component is labelled
+ * after. The root's process adds up all parts and answers every report.
+ *
+ * The small components are spread across the processes by their size: lined
+ * up in the order of their roots' processes, every process takes an equally
+ * long stretch of vertices. This way, every process solves about as many
+ * vertices, no matter which processes own the roots.
+ *
+ * Parameters:
+ * - `g`                Graph structure.
+ * - `labels`           Sorted array of component labels in this process.
+ * - `labels_length`    Array length of parameter `labels`.
+ *
+ * Returns:             Array with, for each label, the process that solves
+ *                      the component, or `bsp_nprocs()` if the component is
+ *                      large.
+ */
+nid_int *judge_components(struct graph *g, nid_int *labels, 
+                          nid_int labels_length) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    nid_int *vertices = calloc(labels_length + 1, sizeof(nid_int));
+    nid_int *targets  = malloc((labels_length + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        nid_int k = search_sorted(labels, labels_length, 
+                                  g->vertex[i]->component);
+        vertices[k]++;
+    }
+
+    // Report the component sizes to the roots.
+    struct todo_list *todo = get_todo_list();
+
+    for (nid_int k=0; k<labels_length; k++) {
+        add_instruction(
+            instruction_component_size(labels[k], vertices[k], p),
+            todo, belongs_to_proc(g, labels[k])
+        );
+    }
+
+    struct instruction *response = send_instructions(todo);
+
+    // Add up the sizes at the roots. The totals are kept in the arrays of
+    // the roots' vertex indices.
+    nid_int *total  = calloc(g->local_degree + 1, sizeof(nid_int));
+    nid_int *solver = malloc((g->local_degree + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<todo->expected_responses; i++) {
+        nid_int index;
+
+        if (response[i].value == COMPONENT_SIZE &&
+            index_of_node(g, response[i].content[0], &index) == 1) {
+            total[index] = total[index] + response[i].content[1];
+        }
+    }
+
+    // Find where the small components of this process start in the line-up
+    // of all small components.
+    nid_int *sizes = calloc(n, sizeof(nid_int));
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        if (total[i] > 0 && total[i] <= SMALL_COMPONENT_SIZE) {
+            sizes[p] = sizes[p] + total[i];
+        }
+    }
+    sum_numbers_across_processes(sizes, n);
+
+    unsigned long long offset = 0;
+    unsigned long long length = 0;
+
+    for (uint q=0; q<n; q++) {
+        if (q < p) {
+            offset = offset + sizes[q];
+        }
+        length = length + sizes[q];
+    }
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        if (total[i] > 0 && total[i] <= SMALL_COMPONENT_SIZE) {
+            solver[i] = offset * n / length;
+            offset    = offset + total[i];
+        }
+    }
+
+    // Answer every report.
+    struct todo_list *verdicts = get_todo_list();
+
+    for (nid_int i=0; i<todo->expected_responses; i++) {
+        nid_int index;
+
+        if (response[i].value == COMPONENT_SIZE &&
+            index_of_node(g, response[i].content[0], &index) == 1) {
+            nid_int small = (total[index] <= SMALL_COMPONENT_SIZE);
+
+            add_instruction(
+                instruction_component_verdict(response[i].content[0], small,
+                                              small ? solver[index] : n),
+                verdicts, response[i].content[2]
+            );
+        }
+    }
+
+    unallocate_todo_list(todo);
+    free(response);
+    free(total);
+    free(solver);
+    free(sizes);
+
+    response = send_instructions(verdicts);
+
+    for (nid_int k=0; k<labels_length; k++) {
+        targets[k] = n;
+    }
+
+    for (nid_int i=0; i<verdicts->expected_responses; i++) {
+        if (response[i].value == COMPONENT_VERDICT && 
+            response[i].content[1] == 1) {
+            nid_int k = search_sorted(labels, labels_length, 
+                                      response[i].content[0]);
+            targets[k] = response[i].content[2];
+        }
+    }
+
+    unallocate_todo_list(verdicts);
+    free(response);
+    free(vertices);
+
+    return targets;
+}
+
+/** PRIVATE
+ * Send all edges of small components to the processes that solve them.
+ *
+ * Every edge is sent once, by the process of its smallest endpoint.
+ *
+ * Parameters:
+ * - `g`                Graph structure.
+ * - `labels`           Sorted array of component labels in this process.
+ * - `labels_length`    Array length of parameter `labels`.
+ * - `targets`          Process that solves each component.
+ * - `edges_length`     Integer that will store the amount of returned edges.
+ *
+ * Returns:             Array of all edges of the small components that this
+ *                      process solves.
+ */
+nid_int (*gather_small_components(struct graph *g, nid_int *labels, 
+                                  nid_int labels_length, nid_int *targets,
+                                  nid_int *edges_length))[2] {
+    uint p = bsp_pid();
+
+    struct todo_list *todo = get_todo_list();
+    nid_int local_edges    = 0;
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        nid_int target  = targets[search_sorted(labels, labels_length, 
+                                                nd->component)];
+
+        if (target == bsp_nprocs()) {
+            continue;
+        }
+
+        compact_edges(nd);
+        for (nid_int j=0; j<nd->degree; j++) {
+            if (nd->value > nd->connections[j]) {
+                continue;
+            }
+
+            if (target == p) {
+                local_edges++;
+            } else {
+                add_instruction(
+                    instruction_component_edge(nd->value, nd->connections[j]),
+                    todo, target
+                );
+            }
+        }
+    }
+
+    struct instruction *response = send_instructions(todo);
+
+    nid_int (*edges)[2] = malloc(
+        2 * (local_edges + todo->expected_responses + 1) * sizeof(nid_int)
+    );
+    *edges_length = 0;
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        nid_int target  = targets[search_sorted(labels, labels_length, 
+                                                nd->component)];
+
+        if (target != p) {
+            continue;
+        }
+
+        compact_edges(nd);
+        for (nid_int j=0; j<nd->degree; j++) {
+            if (nd->value <= nd->connections[j]) {
+                edges[*edges_length][0] = nd->value;
+                edges[*edges_length][1] = nd->connections[j];
+                (*edges_length)++;
+            }
+        }
+    }
+
+    for (nid_int i=0; i<todo->expected_responses; i++) {
+        if (response[i].value == COMPONENT_EDGE) {
+            edges[*edges_length][0] = response[i].content[0];
+            edges[*edges_length][1] = response[i].content[1];
+            (*edges_length)++;
+        }
+    }
+
+    unallocate_todo_list(todo);
+    free(response);
+
+    return edges;
+}
+
+/** PRIVATE
+ * Remove all vertices of small components from the graph.
+ *
+ * No process needs to be notified, as every neighbour of these vertices is
+ * removed as well.
+ *
+ * Parameters:
+ * - `g`                Graph structure.
+ * - `labels`           Sorted array of component labels in this process.
+ * - `labels_length`    Array length of parameter `labels`.
+ * - `targets`          Process that solves each component.
+ */
+void prune_small_components(struct graph *g, nid_int *labels, 
+                            nid_int labels_length, nid_int *targets) {
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        nid_int target  = targets[search_sorted(labels, labels_length, 
+                                                nd->component)];
+
+        if (target != bsp_nprocs()) {
+            count_removed(1, nd->degree);
+            tombstone_node(g, i);
+        }
+    }
+
+    compact_graph(g);
+}
+
+/** PRIVATE
+ * Report how much of the graph is solved without distributed communication.
+ *
+ * Parameters:
+ * - `g`                Graph structure.
+ * - `labels`           Sorted array of component labels in this process.
+ * - `labels_length`    Array length of parameter `labels`.
+ * - `targets`          Process that solves each component.
+ */
+void report_small_components(struct graph *g, nid_int *labels, 
+                             nid_int labels_length, nid_int *targets) {
+    nid_int vertices       = 0;
+    nid_int degrees        = 0;
+    nid_int small_vertices = 0;
+    nid_int small_degrees  = 0;
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        nid_int target  = targets[search_sorted(labels, labels_length, 
+                                                nd->component)];
+
+        vertices++;
+        degrees = degrees + nd->degree;
+
+        if (target != bsp_nprocs()) {
+            small_vertices++;
+            small_degrees = small_degrees + nd->degree;
+        }
+    }
+
+    vertices       = sum_across_processes(vertices);
+    degrees        = sum_across_processes(degrees);
+    small_vertices = sum_across_processes(small_vertices);
+    small_degrees  = sum_across_processes(small_degrees);
+
+    if (bsp_pid() == 0) {
+        printf(
+            "Solved " NID_FORMAT " of " NID_FORMAT " vertices (%.1f%%) and "
+            NID_FORMAT " of " NID_FORMAT " edges (%.1f%%) "
+            "in small components without communication.\n",
+            small_vertices, vertices, 
+            vertices == 0 ? 100.0 : 100.0 * small_vertices / vertices,
+            small_degrees / 2, degrees / 2,
+            degrees == 0 ? 100.0 : 100.0 * small_degrees / degrees
+        );
+    }
+}
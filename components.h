@@ -0,0 +1,15 @@
+
+/**
+ * Match all small connected components without distributed communication.
+ *
+ * The connected components of the graph are found locally with a union-find,
+ * after which their labels are exchanged across processes. Every component
+ * with at most `SMALL_COMPONENT_SIZE` vertices is gathered on a single
+ * process and matched there. Vertices of these components are removed from
+ * the graph, so that only the large components go through the distributed
+ * supersteps.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ */
+void solve_small_components(struct graph *g);
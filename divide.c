@@ -1,5 +1,8 @@
 #include "divide.h"
 
+// Algorithm that `divide()` uses. All processes share it.
+static short int DIVIDE_STRATEGY = DIVIDE_BLOCK;
+
 // PRIVATE FUNCTIONS
 uint block_distribution(nid_int node, nid_int total_nodes, uint processes);
 uint cyclic_distribution(nid_int node, nid_int total_nodes, uint processes);
@@ -17,9 +20,43 @@ uint cyclic_distribution(nid_int node, nid_int total_nodes, uint processes);
  * Returns:         The process to which the node with ID `node` belongs.
  */
 uint divide(nid_int node, nid_int total_nodes, uint processes) {
+    if (DIVIDE_STRATEGY == DIVIDE_CYCLIC) {
+        return cyclic_distribution(node, total_nodes, processes);
+    }
     return block_distribution(node, total_nodes, processes);
 }
 
+/**
+ * Look up the algorithm that `divide()` should use by its name.
+ *
+ * Parameters:
+ * - `name`     Either `block` or `cyclic`.
+ * - `strategy` Will store the algorithm, one of the DIVIDE_* values.
+ *
+ * Returns:     Whether the algorithm exists.
+ */
+bool parse_divide_strategy(const char *name, short int *strategy) {
+    if (strcmp(name, "block") == 0) {
+        *strategy = DIVIDE_BLOCK;
+    } else if (strcmp(name, "cyclic") == 0) {
+        *strategy = DIVIDE_CYCLIC;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Choose the algorithm that `divide()` uses. Call this function before the
+ * processes start.
+ *
+ * Parameters:
+ * - `strategy` One of the DIVIDE_* values.
+ */
+void set_divide_strategy(short int strategy) {
+    DIVIDE_STRATEGY = strategy;
+}
+
 // |----------------------------------------------|
 // |----------------------------------------------|
 // |----------------------------------------------|
@@ -49,7 +86,8 @@ uint divide(nid_int node, nid_int total_nodes, uint processes) {
  * Returns:         The process to which the node with ID `node` belong
  */
 uint block_distribution(nid_int node, nid_int total_nodes, uint processes) {
-    return node * processes / total_nodes;
+    // The product can exceed the largest nid_int on large graphs.
+    return (nid_wide) node * processes / total_nodes;
 }
 
 /** PRIVATE
@@ -12,3 +12,23 @@
  * Returns:         The process to which the node with ID `node` belongs.
  */
 uint divide(nid_int node, nid_int total_nodes, uint processes);
+
+/**
+ * Look up the algorithm that `divide()` should use by its name.
+ *
+ * Parameters:
+ * - `name`     Either `block` or `cyclic`.
+ * - `strategy` Will store the algorithm, one of the DIVIDE_* values.
+ *
+ * Returns:     Whether the algorithm exists.
+ */
+bool parse_divide_strategy(const char *name, short int *strategy);
+
+/**
+ * Choose the algorithm that `divide()` uses. Call this function before the
+ * processes start.
+ *
+ * Parameters:
+ * - `strategy` One of the DIVIDE_* values.
+ */
+void set_divide_strategy(short int strategy);
@@ -0,0 +1,446 @@
+// Generate synthetic graphs in the input format of the matcher.
+//
+// Compile:   gcc -O2 -o generate generate.c
+// Usage:     ./generate [-s seed] [-r] <family> <parameters...>
+//
+// The graph is written to stdout: a line with the amount of vertices and
+// edges, followed by a line for every edge with its two vertices, counted
+// from 1. The same seed always gives the same graph. Generated graphs have no
+// self-loops and no duplicate edges.
+//
+// Families:
+//  er        <n> <m>                   Erdős–Rényi graph with n vertices and
+//                                      m random edges.
+//  rmat      <scale> <edge factor>     R-MAT power-law graph with 2^scale
+//                                      vertices and about edge factor * 2^scale
+//                                      edges, with probabilities (a, b, c, d)
+//                                      = (0.57, 0.19, 0.19, 0.05).
+//  grid2d    <x> <y>                   2D grid of x * y vertices.
+//  grid3d    <x> <y> <z>               3D grid of x * y * z vertices.
+//  path      <n>                       Single path through n vertices.
+//  cycle     <n>                       Single cycle through n vertices.
+//  tree      <n>                       Random tree on n vertices.
+//  bipartite <a> <b> <m>               Random bipartite graph with m edges
+//                                      between a left and b right vertices.
+//
+// Options:
+//  -s <seed>   Seed of the random generator. Defaults to 1.
+//  -r          Shuffle the vertex identifiers, so that neighbouring vertices
+//              don't get neighbouring identifiers.
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main.h"
+
+/**
+ * List of generated edges.
+ *
+ * Attributes:
+ * - `nodes`        Amount of vertices in the graph.
+ * - `edges`        Array of edges. Vertices are counted from 0.
+ * - `length`       Amount of edges in the array.
+ * - `max_length`   Amount of edges that fit in the array.
+ */
+struct edge_list {
+    nid_int nodes;
+
+    nid_int (*edges)[2];
+    unsigned long long length;
+    unsigned long long max_length;
+};
+
+static unsigned long long SEED = 1;
+
+// PRIVATE FUNCTIONS
+void add_edge(struct edge_list *list, nid_int a, nid_int b);
+int compare_edges(const void *a, const void *b);
+struct edge_list *create_edge_list(nid_int nodes, unsigned long long edges);
+void generate_bipartite(struct edge_list *list, nid_int left,
+                        unsigned long long edges);
+void generate_er(struct edge_list *list, unsigned long long edges);
+void generate_grid(struct edge_list *list, nid_int x, nid_int y, nid_int z);
+void generate_rmat(struct edge_list *list, uint scale,
+                   unsigned long long edges);
+void generate_tree(struct edge_list *list);
+unsigned long long random_below(unsigned long long n);
+double random_fraction(void);
+unsigned long long random_number(void);
+void remove_duplicate_edges(struct edge_list *list);
+void shuffle_vertices(struct edge_list *list);
+void write_edge_list(struct edge_list *list);
+
+/**
+ * Read the command line and write the requested graph to stdout.
+ */
+int main(int argc, char **argv) {
+    bool shuffle = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:r")) != -1) {
+        if (option == 's') {
+            SEED = strtoull(optarg, NULL, 10);
+        } else if (option == 'r') {
+            shuffle = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-s seed] [-r] <family> <parameters...>\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "Usage: %s [-s seed] [-r] <family> <parameters...>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char *family = argv[optind];
+    int   params = argc - optind - 1;
+    unsigned long long arg[3] = {0, 0, 0};
+
+    for (int i=0; i<params && i<3; i++) {
+        arg[i] = strtoull(argv[optind + 1 + i], NULL, 10);
+    }
+
+    struct edge_list *list = NULL;
+
+    if (strcmp(family, "er") == 0 && params == 2) {
+        list = create_edge_list(arg[0], arg[1]);
+        generate_er(list, arg[1]);
+    } else if (strcmp(family, "rmat") == 0 && params == 2 && arg[0] < 32) {
+        list = create_edge_list(1ULL << arg[0], arg[1] << arg[0]);
+        generate_rmat(list, arg[0], arg[1] << arg[0]);
+    } else if (strcmp(family, "grid2d") == 0 && params == 2) {
+        list = create_edge_list(arg[0] * arg[1], 2 * arg[0] * arg[1]);
+        generate_grid(list, arg[0], arg[1], 1);
+    } else if (strcmp(family, "grid3d") == 0 && params == 3) {
+        list = create_edge_list(arg[0] * arg[1] * arg[2],
+                                3 * arg[0] * arg[1] * arg[2]);
+        generate_grid(list, arg[0], arg[1], arg[2]);
+    } else if (strcmp(family, "path") == 0 && params == 1) {
+        list = create_edge_list(arg[0], arg[0]);
+        for (nid_int i=1; i<list->nodes; i++) {
+            add_edge(list, i - 1, i);
+        }
+    } else if (strcmp(family, "cycle") == 0 && params == 1 && arg[0] >= 3) {
+        list = create_edge_list(arg[0], arg[0]);
+        for (nid_int i=0; i<list->nodes; i++) {
+            add_edge(list, i, (i + 1) % list->nodes);
+        }
+    } else if (strcmp(family, "tree") == 0 && params == 1) {
+        list = create_edge_list(arg[0], arg[0]);
+        generate_tree(list);
+    } else if (strcmp(family, "bipartite") == 0 && params == 3) {
+        list = create_edge_list(arg[0] + arg[1], arg[2]);
+        generate_bipartite(list, arg[0], arg[2]);
+    } else {
+        fprintf(stderr, "Cannot generate a graph from family %s with %d "
+                        "parameters.\n", family, params);
+        return EXIT_FAILURE;
+    }
+
+    if (shuffle) {
+        shuffle_vertices(list);
+    }
+
+    write_edge_list(list);
+
+    free(list->edges);
+    free(list);
+
+    return EXIT_SUCCESS;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Add an edge to the list. Self-loops are ignored.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ * - `a`        First vertex.
+ * - `b`        Second vertex.
+ */
+void add_edge(struct edge_list *list, nid_int a, nid_int b) {
+    if (a == b) {
+        return;
+    }
+
+    if (list->length == list->max_length) {
+        list->max_length = 2 * list->max_length + 1;
+        list->edges      = realloc(list->edges, list->max_length *
+                                   sizeof(nid_int[2]));
+    }
+
+    list->edges[list->length][0] = a < b ? a : b;
+    list->edges[list->length][1] = a < b ? b : a;
+    list->length++;
+}
+
+/** PRIVATE
+ * Compare two edges, for sorting with `qsort`.
+ */
+int compare_edges(const void *a, const void *b) {
+    const nid_int *x = a;
+    const nid_int *y = b;
+
+    if (x[0] != y[0]) {
+        return (x[0] > y[0]) - (x[0] < y[0]);
+    }
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+/** PRIVATE
+ * Create an empty edge list.
+ *
+ * Parameters:
+ * - `nodes`    Amount of vertices in the graph.
+ * - `edges`    Expected amount of edges in the graph.
+ */
+struct edge_list *create_edge_list(nid_int nodes, unsigned long long edges) {
+    struct edge_list *list = malloc(sizeof(struct edge_list));
+
+    list->nodes      = nodes;
+    list->length     = 0;
+    list->max_length = edges + 1;
+    list->edges      = malloc(list->max_length * sizeof(nid_int[2]));
+
+    return list;
+}
+
+/** PRIVATE
+ * Add random edges between the first `left` vertices and the other vertices.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ * - `left`     Amount of vertices on the left side.
+ * - `edges`    Amount of edges to generate.
+ */
+void generate_bipartite(struct edge_list *list, nid_int left,
+                        unsigned long long edges) {
+    nid_int right = list->nodes - left;
+
+    if (edges > (unsigned long long) left * right) {
+        edges = (unsigned long long) left * right;
+    }
+
+    // Draw more edges until the duplicates are made up for.
+    while (list->length < edges) {
+        while (list->length < edges) {
+            add_edge(list, random_below(left), left + random_below(right));
+        }
+        remove_duplicate_edges(list);
+    }
+}
+
+/** PRIVATE
+ * Add random edges between all vertices.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ * - `edges`    Amount of edges to generate.
+ */
+void generate_er(struct edge_list *list, unsigned long long edges) {
+    unsigned long long n = list->nodes;
+
+    if (edges > n * (n - 1) / 2) {
+        edges = n * (n - 1) / 2;
+    }
+
+    // Draw more edges until the duplicates are made up for.
+    while (list->length < edges) {
+        while (list->length < edges) {
+            add_edge(list, random_below(n), random_below(n));
+        }
+        remove_duplicate_edges(list);
+    }
+}
+
+/** PRIVATE
+ * Connect every vertex of an x * y * z grid to its neighbours.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ * - `x`        Width of the grid.
+ * - `y`        Height of the grid.
+ * - `z`        Depth of the grid, or 1 for a 2D grid.
+ */
+void generate_grid(struct edge_list *list, nid_int x, nid_int y, nid_int z) {
+    for (nid_int k=0; k<z; k++) {
+        for (nid_int j=0; j<y; j++) {
+            for (nid_int i=0; i<x; i++) {
+                nid_int v = (k * y + j) * x + i;
+
+                if (i + 1 < x) { add_edge(list, v, v + 1);     }
+                if (j + 1 < y) { add_edge(list, v, v + x);     }
+                if (k + 1 < z) { add_edge(list, v, v + x * y); }
+            }
+        }
+    }
+}
+
+/** PRIVATE
+ * Add edges with the recursive matrix (R-MAT) model. Every edge picks a
+ * quadrant of the adjacency matrix `scale` times, which gives a power-law
+ * degree distribution. Duplicate edges and self-loops are dropped, so the
+ * graph ends up with fewer edges than requested.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ * - `scale`    Logarithm of the amount of vertices.
+ * - `edges`    Amount of edges to draw.
+ */
+void generate_rmat(struct edge_list *list, uint scale,
+                   unsigned long long edges) {
+    const double a = 0.57;
+    const double b = 0.19;
+    const double c = 0.19;
+
+    for (unsigned long long e=0; e<edges; e++) {
+        nid_int u = 0;
+        nid_int v = 0;
+
+        for (uint bit=0; bit<scale; bit++) {
+            double r = random_fraction();
+
+            if (r < a) {
+                // Top left quadrant
+            } else if (r < a + b) {
+                v = v | (1U << bit);
+            } else if (r < a + b + c) {
+                u = u | (1U << bit);
+            } else {
+                u = u | (1U << bit);
+                v = v | (1U << bit);
+            }
+        }
+
+        add_edge(list, u, v);
+    }
+
+    remove_duplicate_edges(list);
+}
+
+/** PRIVATE
+ * Connect every vertex to a random vertex before it, which gives a random
+ * tree.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ */
+void generate_tree(struct edge_list *list) {
+    for (nid_int i=1; i<list->nodes; i++) {
+        add_edge(list, random_below(i), i);
+    }
+}
+
+/** PRIVATE
+ * Get a random number in the range [0, n).
+ */
+unsigned long long random_below(unsigned long long n) {
+    return random_number() % n;
+}
+
+/** PRIVATE
+ * Get a random number in the range [0, 1).
+ */
+double random_fraction(void) {
+    return (random_number() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/** PRIVATE
+ * Get the next random number of the SplitMix64 generator. Unlike `rand()`,
+ * it gives the same numbers on every platform.
+ */
+unsigned long long random_number(void) {
+    SEED = SEED + 0x9E3779B97F4A7C15ULL;
+
+    unsigned long long z = SEED;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** PRIVATE
+ * Sort the edge list and remove every edge that appears more than once.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ */
+void remove_duplicate_edges(struct edge_list *list) {
+    unsigned long long kept = 0;
+
+    qsort(list->edges, list->length, sizeof(nid_int[2]), compare_edges);
+
+    for (unsigned long long i=0; i<list->length; i++) {
+        if (kept == 0 || compare_edges(list->edges[kept-1], list->edges[i]) != 0) {
+            list->edges[kept][0] = list->edges[i][0];
+            list->edges[kept][1] = list->edges[i][1];
+            kept++;
+        }
+    }
+
+    list->length = kept;
+}
+
+/** PRIVATE
+ * Give every vertex a random new identifier, and put the edges in a random
+ * order.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ */
+void shuffle_vertices(struct edge_list *list) {
+    nid_int *label = malloc((list->nodes + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<list->nodes; i++) {
+        label[i] = i;
+    }
+
+    // Fisher–Yates shuffle
+    for (nid_int i=list->nodes; i>1; i--) {
+        nid_int j    = random_below(i);
+        nid_int temp = label[i-1];
+        label[i-1]   = label[j];
+        label[j]     = temp;
+    }
+
+    for (unsigned long long i=list->length; i>0; i--) {
+        unsigned long long j = random_below(i);
+        nid_int a = list->edges[j][0];
+        nid_int b = list->edges[j][1];
+
+        list->edges[j][0]   = list->edges[i-1][0];
+        list->edges[j][1]   = list->edges[i-1][1];
+        list->edges[i-1][0] = label[a];
+        list->edges[i-1][1] = label[b];
+    }
+
+    free(label);
+}
+
+/** PRIVATE
+ * Write the edge list to stdout in the input format of the matcher.
+ *
+ * Parameters:
+ * - `list`     Edge list.
+ */
+void write_edge_list(struct edge_list *list) {
+    printf(NID_FORMAT " %llu\n", list->nodes, list->length);
+
+    for (unsigned long long i=0; i<list->length; i++) {
+        printf(NID_FORMAT " " NID_FORMAT "\n", list->edges[i][0] + 1, 
+               list->edges[i][1] + 1);
+    }
+}
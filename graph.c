@@ -2,14 +2,17 @@
 #include "graph.h"
 #include "instructions.h"
 #include "match.h"
+#include "placement.h"
+#include "stats.h"
+#include "trace.h"
 #include "utilities.h"
 
 // PRIVATE FUNCTIONS
-bool belongs_here(struct graph *g, nid_int n);
 nid_int count_unique_nodes(nid_int (*edges)[2], nid_int edges_length);
-nid_int index_of_node(struct graph* g, nid_int n, nid_int *index);
 struct graph *create_graph(nid_int max_size, nid_int global_size);
-uint belongs_to_proc(struct graph *g, nid_int n);
+bool edge_removed(struct node *nd, nid_int i);
+unsigned long long edge_priority(nid_int a, nid_int b, nid_int round);
+nid_int find_edge(struct node *nd, nid_int n);
 
 /**
  * Create a graph structure based on a given set of edges.
@@ -20,50 +23,116 @@ uint belongs_to_proc(struct graph *g, nid_int n);
  *                  (sub)graph.
  * - `edges`        Array of edges that have at least one endpoint in this
  *                  (sub)graph.
+ * - `weights`      Weight of every edge, or NULL for an unweighted graph.
  *
  * Returns:         Pointer to a newly created graph structure.
  */
 struct graph *load_structure(nid_int total_nodes, nid_int local_edges, 
-                                                  nid_int (*edges)[2]) {
+                             nid_int (*edges)[2], double *weights) {
     nid_int maximum_nodes = count_unique_nodes(edges, local_edges);
 
     struct graph *g = create_graph(maximum_nodes, total_nodes);
 
+    // Collect the endpoints that belong to this process.
+    nid_int *nodes        = malloc((2 * local_edges + 1) * sizeof(nid_int));
+    nid_int  nodes_length = 0;
+
+    for (nid_int i=0; i<local_edges; i++) {
+        for (unsigned short int j=0; j<2; j++) {
+            if (belongs_here(g, edges[i][j])) {
+                nodes[nodes_length] = edges[i][j];
+                nodes_length++;
+            }
+        }
+    }
+    qsort(nodes, nodes_length, sizeof(nid_int), compare_nids);
+
+    nid_int unique_length = 0;
+    for (nid_int i=0; i<nodes_length; i++) {
+        if (unique_length == 0 || nodes[unique_length-1] != nodes[i]) {
+            nodes[unique_length] = nodes[i];
+            unique_length++;
+        }
+    }
+    nodes_length = unique_length;
+
+    // Count how many edges connect to each node.
+    nid_int *connections = calloc(nodes_length + 1, sizeof(nid_int));
+
+    OMP(omp parallel for)
+    for (nid_int i=0; i<local_edges; i++) {
+        for (unsigned short int j=0; j<2; j++) {
+            if (belongs_here(g, edges[i][j])) {
+                nid_int k = search_sorted(nodes, nodes_length, edges[i][j]);
+
+                OMP(omp atomic)
+                connections[k]++;
+            }
+        }
+    }
+
+    // Add nodes
+    OMP(omp parallel for)
+    for (nid_int k=0; k<nodes_length; k++) {
+        g->vertex[k] = create_node(nodes[k], connections[k], weights != NULL);
+        g->values[k] = nodes[k];
+    }
+    g->local_degree = nodes_length;
+    g->alive        = nodes_length;
+
+    // Insert connections
+    OMP(omp parallel for)
     for (nid_int i=0; i<local_edges; i++) {
         for (unsigned short int j=0; j<2; j++) {
             nid_int node      = edges[i][j];
             nid_int neighbour = edges[i][1-j];
 
-            // Let's take a look at this endpoint!
-            // As long as it belongs to this process, of course.
             if (belongs_here(g, node)) {
-                nid_int index = 0;
-
-                if (index_of_node(g, node, &index) == 0) {
-                    // Count how many edges connect to this node.
-                    nid_int connections = 0;
-                    for (nid_int j=i; j<local_edges; j++) {
-                        if (edges[j][0] == node || edges[j][1] == node) {
-                            connections++;
-                        }
-                    }
-
-                    // Add node
-                    index            = g->local_degree;
-                    g->vertex[index] = create_node(node, connections);
-                    g->local_degree  = index + 1;
-                }
+                struct node *nd = g->vertex[search_sorted(nodes, nodes_length,
+                                                          node)];
+                nid_int size;
 
-                // Insert connection
-                struct node *nd = g->vertex[index];
-                nid_int size    = nd->degree;
+                OMP(omp atomic capture)
+                size = nd->degree++;
 
                 nd->connections[size] = neighbour;
-                nd->degree            = size + 1;
+
+                if (weights != NULL) {
+                    nd->weights[size] = weights[i];
+                }
             }
         }
     }
 
+    // Index the connections by neighbour, so that `remove_edge` can find a
+    // neighbour quickly. The connections themselves keep their order.
+    OMP(omp parallel for)
+    for (nid_int k=0; k<nodes_length; k++) {
+        struct node *nd = g->vertex[k];
+        nid_int (*pairs)[2] = malloc((nd->degree + 1) * sizeof(nid_int[2]));
+
+        for (nid_int i=0; i<nd->degree; i++) {
+            pairs[i][0] = nd->connections[i];
+            pairs[i][1] = i;
+        }
+        qsort(pairs, nd->degree, sizeof(nid_int[2]), compare_edges);
+
+        for (nid_int i=0; i<nd->degree; i++) {
+            nd->order[i] = pairs[i][1];
+        }
+
+        nd->length = nd->degree;
+        free(pairs);
+    }
+
+    // Every node still has to be looked at in the first round.
+    for (nid_int k=0; k<nodes_length; k++) {
+        activate_node(g, g->vertex[k]);
+    }
+
+    free(nodes);
+    free(connections);
+
     return g;
 }
 
@@ -73,17 +142,81 @@ struct graph *load_structure(nid_int total_nodes, nid_int local_edges,
  * Parameters:
  * - `n`            Unique node identifier.
  * - `degree`       Array length of parameter `connections`.
+ * - `weighted`     Whether the connections have weights.
  */
-struct node *create_node(nid_int n, nid_int degree) {
+struct node *create_node(nid_int n, nid_int degree, bool weighted) {
     struct node *nd  = malloc(       1 * sizeof(struct node));
     nd->connections  = malloc(degree   * sizeof(nid_int)    );
+    nd->order        = malloc(degree   * sizeof(nid_int)    );
+    nd->weights      = weighted ? malloc(degree * sizeof(double)) : NULL;
 
-    nd->degree = 0;
-    nd->value  = n;
+    nd->removed   = NULL;
+    nd->length    = 0;
+    nd->degree    = 0;
+    nd->active    = false;
+    nd->claimed   = false;
+    nd->value     = n;
+    nd->component = n;
 
     return nd;
 }
 
+/**
+ * Check whether a given node belongs in this process.
+ * 
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `n`        Unique node identifier.
+ *
+ * Returns:     boolean whether the node identifier should be in this process.
+ */
+bool belongs_here(struct graph *g, nid_int n) {
+    return (belongs_to_proc(g, n) == g->pid);
+}
+
+/**
+ * Determine the index of a node in the graph.
+ *
+ * The index stays valid until the graph is compacted, even if other nodes are
+ * removed in the meantime.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `n`        Unique node identifier.
+ * - `index`    Pointer to the integer that stores the index.
+ *
+ * Returns:      /  0    if the node doesn't exist in the graph (yet) \
+ *               |  1    if the node was found                        |
+ *               \  2    if the node should be in a different process /
+ */
+nid_int index_of_node(struct graph* g, nid_int n, nid_int *index) {
+    if (!belongs_here(g, n)) {
+        return 2;
+    }
+
+    nid_int i = search_sorted(g->values, g->local_degree, n);
+
+    if (i == g->local_degree || g->vertex[i] == NULL) {
+        return 0;
+    }
+
+    *index = i;
+    return 1;
+}
+
+/**
+ * Determine in to which process a given node ID belongs.
+ * 
+ * Parameters:
+ * - `g`        Pointer to this process' graph structure.
+ * - `n`        Unique node identifier.
+ *
+ * Returns:     The process that node `n` belongs to.
+ */
+uint belongs_to_proc(struct graph *g, nid_int n) {
+    return divide(n, g->global_degree, g->processes);
+}
+
 void interpret_instruction(struct todo_list *todo, struct graph *g, 
                            struct instruction *ins) {
     short int name = ins->value;
@@ -112,7 +245,7 @@ void interpret_instruction(struct todo_list *todo, struct graph *g,
     else if (name == DELETE) {
         nid_int index;
         if (index_of_node(g, ins->content[1], &index) == 1) {
-            remove_edge(g->vertex[index], ins->content[0]);
+            remove_edge(g, g->vertex[index], ins->content[0]);
         }
 
     }
@@ -136,6 +269,17 @@ void interpret_instruction(struct todo_list *todo, struct graph *g,
         if (index_of_node(g, ins->content[1], &index) == 1) {
             insert_match(g->m, ins->content[0], ins->content[1]);
             remove_node(todo, g, ins->content[1]);
+        } else {
+            // Two singletons that only know each other were both moved. Then
+            // both processes get here, and the one of the lowest node stores
+            // the match.
+            nid_int pair[2] = {ins->content[1], ins->content[0]};
+
+            if (pair[0] < pair[1] &&
+                bsearch(pair, g->moved, g->moved_length, 2 * sizeof(nid_int),
+                        compare_edges) != NULL) {
+                insert_match(g->m, pair[0], pair[1]);
+            }
         }
     }
 
@@ -159,52 +303,209 @@ void interpret_instruction(struct todo_list *todo, struct graph *g,
     }
 }
 
+/**
+ * Interpret all instructions that were received from other processes.
+ *
+ * DELETE instructions only change the node that they are addressed to, so
+ * they are spread across threads by that node. Every other instruction is
+ * interpreted in order afterwards.
+ *
+ * Parameters:
+ * - `todo`         Todo structure that tracks optional instructions.
+ * - `g`            Graph structure.
+ * - `inss`         Array of received instructions.
+ * - `inss_length`  Array length of parameter `inss`.
+ */
+void interpret_instructions(struct todo_list *todo, struct graph *g,
+                            struct instruction *inss, nid_int inss_length) {
+    OMP(omp parallel)
+    {
+        uint t       = thread_id();
+        uint threads = thread_count();
+
+        for (nid_int i=0; i<inss_length; i++) {
+            if (inss[i].value == DELETE && inss[i].content[1] % threads == t) {
+                interpret_instruction(todo, g, &(inss[i]));
+            }
+        }
+    }
+
+    for (nid_int i=0; i<inss_length; i++) {
+        if (inss[i].value != DELETE) {
+            interpret_instruction(todo, g, &(inss[i]));
+        }
+    }
+}
+
 /**
  * Remove an edge from a node.
  *
+ * A removal takes O(log d) time for a node of degree d: `find_edge()` finds
+ * the edge through binary search in `order`, and the edge is only marked as
+ * removed. Once half of the connections are removed, they are dropped from
+ * the array, which takes constant amortized time per removal. The degree
+ * only changes if the node still had the edge, and then the node joins the
+ * frontier of the next pass.
+ *
  * Parameters:
+ * - `g`        Graph structure.
  * - `nd`       Pointer to the node structure.
  * - `n`        Unique node identifier that needs to be removed.
  */
-void remove_edge(struct node *nd, nid_int n) {
+void remove_edge(struct graph *g, struct node *nd, nid_int n) {
+    nid_int i = find_edge(nd, n);
+
+    if (i == nd->length || edge_removed(nd, i)) {
+        return;
+    }
+
+    // Most nodes never lose an edge, so the bitmap is allocated on demand.
+    if (nd->removed == NULL) {
+        nd->removed = calloc(nd->length / 64 + 1, sizeof(unsigned long long));
+    }
+
+    nd->removed[i / 64] |= 1ULL << (i % 64);
     nd->degree--;
-    nid_int i = 0;
+    activate_node(g, nd);
+
+    if (2 * nd->degree <= nd->length) {
+        compact_edges(nd);
+    }
+}
+
+/**
+ * Drop the removed edges of a node from its connections, so that its first
+ * `degree` connections are exactly its neighbours. The connections keep
+ * their order.
+ *
+ * Every function that reads the connections of a node calls this first.
+ *
+ * Parameters:
+ * - `nd`       Pointer to the node structure.
+ */
+void compact_edges(struct node *nd) {
+    if (nd->removed == NULL) {
+        return;
+    }
+
+    nid_int *position = malloc((nd->length + 1) * sizeof(nid_int));
+    nid_int kept      = 0;
+
+    for (nid_int i=0; i<nd->length; i++) {
+        if (!edge_removed(nd, i)) {
+            nd->connections[kept] = nd->connections[i];
+            position[i]           = kept;
 
-    for (; i<nd->degree; i++) {
-        if (nd->connections[i] == n) {
-            break;
+            if (nd->weights != NULL) {
+                nd->weights[kept] = nd->weights[i];
+            }
+            kept++;
         }
     }
 
-    for (; i<nd->degree; i++) {
-        nd->connections[i] = nd->connections[i+1];
+    // The index keeps its order, with the new positions.
+    kept = 0;
+
+    for (nid_int k=0; k<nd->length; k++) {
+        if (!edge_removed(nd, nd->order[k])) {
+            nd->order[kept] = position[nd->order[k]];
+            kept++;
+        }
     }
+
+    nd->length = kept;
+    free(position);
+    free(nd->removed);
+    nd->removed = NULL;
 }
 
 /**
- * Remove nodes from the graph that have a degree of 0.
+ * Remove nodes from the graph that have a degree of 0. Only the given nodes
+ * are looked at, as other nodes can't have lost an edge.
+ *
+ * The nodes are only marked as removed. The graph is compacted later, by
+ * `remove_singletons()`.
  *
  * Parameters:
- * - `g`        Graph structure.
+ * - `g`            Graph structure.
+ * - `nodes`        Unique node identifiers of the nodes to look at.
+ * - `nodes_length` Array length of parameter `nodes`.
  */
-void remove_empty_nodes(struct graph *g) {
-    nid_int *empty_nodes = malloc(g->local_degree * sizeof(nid_int));
-    nid_int empty_length = 0;
+void remove_empty_nodes(struct graph *g, nid_int *nodes, nid_int nodes_length) {
+    nid_int removed = 0;
 
-    for (nid_int i=0; i<g->local_degree; i++) {
-        struct node *nd = g->vertex[i];
+    for (nid_int k=0; k<nodes_length; k++) {
+        nid_int index;
 
-        if (nd->degree == 0) {
-            empty_nodes[empty_length] = nd->value;
-            empty_length++;
+        if (index_of_node(g, nodes[k], &index) == 1 && 
+            g->vertex[index]->degree == 0) {
+            tombstone_node(g, index);
+            removed++;
         }
     }
 
-    for (nid_int i=0; i<empty_length; i++) {
-        remove_node(NULL, g, empty_nodes[i]);
+    count_removed(removed, 0);
+}
+
+/**
+ * Drop the removed nodes from the vertex array, so that every entry up to
+ * `local_degree` is a node. The nodes keep their order.
+ *
+ * This changes the indices of the nodes, so nobody may hold on to an index
+ * of `index_of_node()` across this call.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ */
+void compact_graph(struct graph *g) {
+    if (g->alive == g->local_degree) {
+        return;
     }
 
-    free(empty_nodes);
+    nid_int *kept        = calloc(max_thread_count() + 1, sizeof(nid_int));
+    nid_int local_degree = g->local_degree;
+
+    // Every thread keeps the nodes of its own block of the array.
+    struct node **vertex = local_malloc(g->max_size * sizeof(struct node *));
+    nid_int      *values = local_malloc(g->max_size * sizeof(nid_int));
+
+    OMP(omp parallel)
+    {
+        uint t       = thread_id();
+        uint threads = thread_count();
+
+        nid_int start = (unsigned long long) local_degree * t       / threads;
+        nid_int end   = (unsigned long long) local_degree * (t + 1) / threads;
+
+        for (nid_int i=start; i<end; i++) {
+            if (g->vertex[i] != NULL) {
+                kept[t+1]++;
+            }
+        }
+
+        OMP(omp barrier)
+
+        nid_int offset = 0;
+        for (uint s=0; s<=t; s++) {
+            offset = offset + kept[s];
+        }
+
+        for (nid_int i=start; i<end; i++) {
+            if (g->vertex[i] != NULL) {
+                vertex[offset] = g->vertex[i];
+                values[offset] = g->values[i];
+                offset++;
+            }
+        }
+    }
+
+    g->local_degree = sum(kept, max_thread_count() + 1);
+
+    free(g->vertex);
+    free(g->values);
+    free(kept);
+    g->vertex = vertex;
+    g->values = values;
 }
 
 /**
@@ -217,16 +518,18 @@ void remove_empty_nodes(struct graph *g) {
  */
 void remove_node(struct todo_list *todo, struct graph *g, nid_int n) {
     nid_int index = 0;
-    printf("[PID %u] Let's remove node %u!\n", bsp_pid(), n);
+    TRACE(TRACE_CHANGES, "Remove node " NID_FORMAT, n);
 
     nid_int outcome = index_of_node(g, n, &index);
 
     if (outcome != 1) {
-        printf("[PID %u] Huh, strange. I can't find node %u.\n", bsp_pid(), n);
+        TRACE(TRACE_CHANGES, "Cannot find node " NID_FORMAT " to remove", n);
         return;
     }
 
     struct node *nd = g->vertex[index];
+    count_removed(1, nd->degree);
+    compact_edges(nd);
             
     // Make all neighbours forget you ever existed.
     for (nid_int i=0; i<nd->degree; i++) {
@@ -236,7 +539,7 @@ void remove_node(struct todo_list *todo, struct graph *g, nid_int n) {
 
         if (outcome == 1) {         // Neighbour was found
 
-            remove_edge(g->vertex[nindex], n);
+            remove_edge(g, g->vertex[nindex], n);
 
         } else if (outcome == 2) {  // Neighbour is in another process
 
@@ -246,50 +549,428 @@ void remove_node(struct todo_list *todo, struct graph *g, nid_int n) {
         }
     }
 
-    g->local_degree--;
-    // Remove the node itself.
-    for (nid_int i=index; i<g->local_degree; i++) {
-        g->vertex[i] = g->vertex[i+1];
-    }
-    unallocate_node(nd);
+    // Remove the node itself. Its entry stays behind until the graph is
+    // compacted, so that the indices of other nodes stay valid.
+    tombstone_node(g, index);
 }
 
 /**
  * Remove singletons from the graph by matching them to their only neighbour.
  *
+ * Every pass only looks at the frontier: the nodes whose degree changed since
+ * the previous pass, or since the previous round through the instructions of
+ * other processes. The cost of a round thus follows the amount of changes
+ * instead of the size of the graph.
+ *
  * Parameters:
  * - `todo`     Todo structure that tracks optional instructions.
  * - `g`        Graph structure.
  */
 void remove_singletons(struct todo_list *todo, struct graph *g) {
+    uint threads = max_thread_count();
+
+    // Every thread writes its instructions to its own todo list.
+    struct todo_list **thread_todo = malloc(threads * sizeof(struct todo_list *));
+    for (uint t=0; t<threads; t++) {
+        thread_todo[t] = get_todo_list();
+    }
+
     bool singleton_found = true;
+    g->moved_length = 0;
 
     while (singleton_found) {
-        singleton_found = false;
+        // Only the nodes whose degree changed can have become singletons. They
+        // are looked at in order, like a scan of the whole graph would.
+        nid_int  active_length = g->frontier_length;
+        nid_int *active        = malloc((active_length + 1) * sizeof(nid_int));
+
+        memcpy(active, g->frontier, active_length * sizeof(nid_int));
+        qsort(active, active_length, sizeof(nid_int), compare_nids);
+        g->frontier_length = 0;
+
+        nid_int (*singletons)[2] = malloc(2 * (active_length + 1) * sizeof(nid_int));
+        nid_int  singletons_length = 0;
+
+        // Find all singletons and claim their neighbours.
+        OMP(omp parallel for)
+        for (nid_int k=0; k<active_length; k++) {
+            nid_int i;
+
+            if (index_of_node(g, active[k], &i) != 1) {
+                continue;
+            }
 
-        for (nid_int i=0; i<g->local_degree; i++) {
             struct node *nd = g->vertex[i];
 
-            if (nd->degree == 1) {  // We found a singleton!
-                nid_int neighbour = nd->connections[0];
+            if (nd->degree != 1) {
+                continue;
+            }
+
+            compact_edges(nd);
+            nid_int neighbour = nd->connections[0];
+            nid_int index;
+            nid_int outcome   = index_of_node(g, neighbour, &index);
 
-                if (belongs_here(g, neighbour)) {
-                    remove_node(todo, g, neighbour);
-                    insert_match(g->m, nd->value, neighbour);
-                } else {
-                    add_instruction(instruction_move_node(nd->value, neighbour),
-                        todo, belongs_to_proc(g, neighbour)
-                    );
+            if (outcome == 2) {
+                add_instruction(instruction_move_node(nd->value, neighbour),
+                    thread_todo[thread_id()], belongs_to_proc(g, neighbour)
+                );
+
+                nid_int size;
+
+                OMP(omp atomic capture)
+                size = g->moved_length++;
+
+                g->moved[size][0] = nd->value;
+                g->moved[size][1] = neighbour;
+            } else if (outcome == 1) {
+                struct node *other = g->vertex[index];
+
+                // When two singletons of this pass only know each other, 
+                // the one with the lowest index makes the match.
+                if (other->degree == 1 && other->active && index < i) {
+                    continue;
+                }
+
+                // Only one singleton may take the neighbour. A claimed
+                // neighbour is always removed below.
+                if (!__sync_bool_compare_and_swap(&(other->claimed), false, true)) {
+                    continue;
                 }
-                remove_node(todo, g, nd->value);
+            } else {
+                continue;
+            }
+
+            nid_int size;
+
+            OMP(omp atomic capture)
+            size = singletons_length++;
+
+            singletons[size][0] = nd->value;
+            singletons[size][1] = neighbour;
+        }
+
+        // The nodes may join the frontier again from here on.
+        for (nid_int k=0; k<active_length; k++) {
+            nid_int i;
+
+            if (index_of_node(g, active[k], &i) == 1) {
+                g->vertex[i]->active = false;
+            }
+        }
+        remove_empty_nodes(g, active, active_length);
+
+        // Remove the singletons and their matched neighbours.
+        for (nid_int i=0; i<singletons_length; i++) {
+            nid_int singleton = singletons[i][0];
+            nid_int neighbour = singletons[i][1];
+
+            if (belongs_here(g, neighbour)) {
+                remove_node(todo, g, neighbour);
+                insert_match(g->m, singleton, neighbour);
+            }
+            remove_node(todo, g, singleton);
+
+            // A neighbour in another process leaves the graph in the next
+            // exchange either way: it takes the singleton, or it was taken
+            // already. The next pass may build on that right away.
+            if (!belongs_here(g, neighbour)) {
+                remove_ghost(g, neighbour);
+            }
+        }
+
+        singleton_found = (singletons_length > 0);
+
+        free(active);
+        free(singletons);
+    }
+
+    for (uint t=0; t<threads; t++) {
+        merge_todo_lists(todo, thread_todo[t]);
+        unallocate_todo_list(thread_todo[t]);
+    }
+    free(thread_todo);
+
+    qsort(g->moved, g->moved_length, 2 * sizeof(nid_int), compare_edges);
+
+    // No index is held here, so this is a safe moment to compact.
+    if (g->local_degree - g->alive > DEAD_VERTEX_FRACTION * g->local_degree) {
+        compact_graph(g);
+    }
+}
+
+/**
+ * Match the locally dominant edges of the graph, for when no singletons are
+ * left anywhere. Every node picks the edge with the highest random priority
+ * among its own edges, and two nodes that pick each other are matched. This
+ * never matches a node twice, and the edge with the highest priority of the
+ * whole graph is always picked by both of its endpoints, so at least one edge
+ * is matched while any are left.
+ *
+ * In a weighted graph, every node picks its heaviest edge instead, and the
+ * priority only breaks ties. Calling this function until no edges are left
+ * then gives a matching of at least half the maximum weight.
+ *
+ * The matched nodes are removed, which may create new singletons. The
+ * instructions for their neighbours in other processes are added to `todo`.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `todo`     Todo structure that tracks optional instructions.
+ * - `g`        Graph structure.
+ * - `round`    Round of the superstep loop, which chooses the priorities.
+ *
+ * Returns:     Whether any process still had an edge.
+ */
+bool match_dominant_edges(struct todo_list *todo, struct graph *g,
+                          nid_int round) {
+    nid_int *choice = malloc((g->local_degree + 1) * sizeof(nid_int));
+    double  *weight = malloc((g->local_degree + 1) * sizeof(double));
+    nid_int  edges  = 0;
+
+    // Every node picks its heaviest edge, and then the one with the highest
+    // priority. Ties go to the highest neighbour, so that both endpoints
+    // agree on the order.
+    OMP(omp parallel for reduction(+:edges))
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+        choice[i] = NO_MATE;
+        weight[i] = 0;
+
+        if (nd == NULL || nd->degree == 0) {
+            continue;
+        }
+
+        edges += nd->degree;
 
-                singleton_found = true;
-                break;
+        unsigned long long best = 0;
+
+        // Removed edges are skipped rather than compacted, as `remove_edge()`
+        // already compacts a node once half of its edges are gone.
+        for (nid_int j=0; j<nd->length; j++) {
+            if (edge_removed(nd, j)) {
+                continue;
+            }
+
+            nid_int neighbour           = nd->connections[j];
+            double  heavy               = (nd->weights != NULL) ? 
+                                          nd->weights[j] : 0;
+            unsigned long long priority = edge_priority(nd->value, neighbour, 
+                                                        round);
+
+            if (choice[i] == NO_MATE || heavy > weight[i] ||
+                (heavy == weight[i] && (priority > best || 
+                 (priority == best && neighbour > choice[i])))) {
+                choice[i] = neighbour;
+                weight[i] = heavy;
+                best      = priority;
             }
         }
     }
 
-    remove_empty_nodes(g);
+    if (sum_across_processes(edges) == 0) {
+        free(choice);
+        free(weight);
+        return false;
+    }
+
+    // Matches are found while the indices are still valid, and only made
+    // afterwards, as removing a node may change the choice of others.
+    nid_int (*matches)[2] = malloc(2 * (g->local_degree + 1) * sizeof(nid_int));
+    double   *matched     = malloc((g->local_degree + 1) * sizeof(double));
+    nid_int  matches_length = 0;
+
+    struct todo_list *proposals = get_todo_list();
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        if (choice[i] == NO_MATE) {
+            continue;
+        }
+
+        nid_int index;
+        nid_int outcome = index_of_node(g, choice[i], &index);
+
+        if (outcome == 2) {
+            add_instruction(
+                instruction_propose_match(g->vertex[i]->value, choice[i]),
+                proposals, belongs_to_proc(g, choice[i])
+            );
+        } else if (outcome == 1 && choice[index] == g->vertex[i]->value && 
+                   index < i) {
+            matches[matches_length][0] = g->vertex[i]->value;
+            matches[matches_length][1] = choice[i];
+            matched[matches_length]    = weight[i];
+            matches_length++;
+        }
+    }
+
+    struct instruction *response = send_instructions(proposals);
+
+    // A proposal from another process is mutual if the node proposed back.
+    for (nid_int i=0; i<proposals->expected_responses; i++) {
+        if (response[i].value != PROPOSE) {
+            continue;
+        }
+
+        nid_int index;
+
+        if (index_of_node(g, response[i].content[1], &index) == 1 &&
+            choice[index] == response[i].content[0]) {
+            matches[matches_length][0] = response[i].content[1];
+            matches[matches_length][1] = response[i].content[0];
+            matched[matches_length]    = weight[index];
+            matches_length++;
+        }
+    }
+
+    // Both processes of a match between processes remove their own node,
+    // but only the process with the lowest node stores the match.
+    for (nid_int i=0; i<matches_length; i++) {
+        nid_int node    = matches[i][0];
+        nid_int partner = matches[i][1];
+
+        if (belongs_here(g, partner)) {
+            remove_node(todo, g, partner);
+            insert_match(g->m, node, partner);
+            g->m->weight = g->m->weight + matched[i];
+            g->guessed++;
+        } else if (node < partner) {
+            insert_match(g->m, node, partner);
+            g->m->weight = g->m->weight + matched[i];
+            g->guessed++;
+        }
+        remove_node(todo, g, node);
+
+        if (!belongs_here(g, partner)) {
+            remove_ghost(g, partner);
+        }
+    }
+
+    unallocate_todo_list(proposals);
+    free(response);
+    free(matches);
+    free(matched);
+    free(choice);
+    free(weight);
+
+    return true;
+}
+
+/**
+ * Index the edges of this process to nodes of other processes, so that
+ * `remove_ghost()` can find them. Until then, `remove_ghost()` does nothing.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ */
+void index_ghosts(struct graph *g) {
+    nid_int length = 0;
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+
+        if (nd != NULL) {
+            compact_edges(nd);
+            length = length + nd->degree;
+        }
+    }
+
+    free(g->ghosts);
+    g->ghosts        = malloc(2 * (length + 1) * sizeof(nid_int));
+    g->ghosts_length = 0;
+
+    for (nid_int i=0; i<g->local_degree; i++) {
+        struct node *nd = g->vertex[i];
+
+        if (nd == NULL) {
+            continue;
+        }
+
+        for (nid_int j=0; j<nd->degree; j++) {
+            if (!belongs_here(g, nd->connections[j])) {
+                g->ghosts[g->ghosts_length][0] = nd->connections[j];
+                g->ghosts[g->ghosts_length][1] = nd->value;
+                g->ghosts_length++;
+            }
+        }
+    }
+    qsort(g->ghosts, g->ghosts_length, sizeof(nid_int[2]), compare_edges);
+}
+
+/**
+ * Remove the edges of this process to a node of another process, before
+ * that process sends the instructions to delete them. This only works after
+ * `index_ghosts()`, and the later instructions then change nothing.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `n`        Unique node identifier of the node in another process.
+ */
+void remove_ghost(struct graph *g, nid_int n) {
+    if (g->ghosts == NULL) {
+        return;
+    }
+
+    nid_int low  = 0;
+    nid_int high = g->ghosts_length;
+
+    while (low < high) {
+        nid_int middle = low + (high - low) / 2;
+
+        if (g->ghosts[middle][0] < n) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    for (nid_int k=low; k<g->ghosts_length && g->ghosts[k][0] == n; k++) {
+        nid_int index;
+
+        if (index_of_node(g, g->ghosts[k][1], &index) == 1) {
+            remove_edge(g, g->vertex[index], n);
+        }
+    }
+}
+
+/**
+ * Add a node to the frontier: the nodes whose degree changed since the last
+ * pass of `remove_singletons()` looked at them. A node is only added once.
+ *
+ * Threads may call this function at the same time for different nodes.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `nd`       Pointer to the node structure.
+ */
+void activate_node(struct graph *g, struct node *nd) {
+    if (nd->active) {
+        return;
+    }
+    nd->active = true;
+
+    nid_int size;
+
+    OMP(omp atomic capture)
+    size = g->frontier_length++;
+
+    g->frontier[size] = nd->value;
+}
+
+/**
+ * Remove the node at an index from the graph, and free it. Its entry is
+ * marked as removed instead of closing the gap, so that the indices of other
+ * nodes stay valid until `compact_graph()`.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `index`    Index of the node.
+ */
+void tombstone_node(struct graph *g, nid_int index) {
+    unallocate_node(g->vertex[index]);
+    g->vertex[index] = NULL;
+    g->alive--;
 }
 
 /**
@@ -303,11 +984,17 @@ void remove_singletons(struct todo_list *todo, struct graph *g) {
 void unallocate_graph(struct graph *g) {
     // Free the nodes
     for (nid_int i=0; i<g->local_degree; i++) {
-        unallocate_node(g->vertex[i]);
+        if (g->vertex[i] != NULL) {
+            unallocate_node(g->vertex[i]);
+        }
     }
 
     unallocate_matching(g->m);
     free(g->vertex);
+    free(g->values);
+    free(g->frontier);
+    free(g->moved);
+    free(g->ghosts);
     free(g);
 }
 
@@ -319,6 +1006,9 @@ void unallocate_graph(struct graph *g) {
  */
 void unallocate_node(struct node *nd) {
     free(nd->connections);
+    free(nd->weights);
+    free(nd->order);
+    free(nd->removed);
     free(nd);
 }
 
@@ -333,19 +1023,6 @@ void unallocate_node(struct node *nd) {
 // |----------------------------------------------|
 // |----------------------------------------------|
 
-/** PRIVATE
- * Check whether a given node belongs in this process.
- * 
- * Parameters:
- * - `g`        Graph structure.
- * - `n`        Unique node identifier.
- *
- * Returns:     boolean whether the node identifier should be in this process.
- */
-bool belongs_here(struct graph *g, nid_int n) {
-    return (belongs_to_proc(g, n) == bsp_pid());
-}
-
 /** PRIVATE
  * Count the amount of unique endpoints in an array of edges.
  *
@@ -368,33 +1045,6 @@ nid_int count_unique_nodes(nid_int (*edges)[2], nid_int edges_length) {
     return answer;
 }
 
-/** PRIVATE
- * Determine the index of a node in the graph.
- *
- * Parameters:
- * - `g`        Graph structure.
- * - `n`        Unique node identifier.
- * - `index`    Pointer to the integer that stores the index.
- *
- * Returns:      /  0    if the node doesn't exist in the graph (yet) \
- *               |  1    if the node was found                        |
- *               \  2    if the node should be in a different process /
- */
-nid_int index_of_node(struct graph* g, nid_int n, nid_int *index) {
-    if (!belongs_here(g, n)) {
-        return 2;
-    }
-
-    for (nid_int i=0; i<g->local_degree; i++) {
-        if (g->vertex[i]->value == n) {
-            *index = i;
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
 /** PRIVATE
  * Create a graph structure that this process may manage.
  *
@@ -407,25 +1057,92 @@ nid_int index_of_node(struct graph* g, nid_int n, nid_int *index) {
  */
 struct graph *create_graph(nid_int max_size, nid_int global_size) {
     struct graph *g  = malloc(       1 * sizeof(struct graph ));
-    g->vertex        = malloc(max_size * sizeof(struct node *));
+    g->vertex        = local_malloc(max_size * sizeof(struct node *));
+    g->values        = local_malloc(max_size * sizeof(nid_int));
+    g->frontier      = malloc(max_size * sizeof(nid_int));
+    g->moved         = malloc(2 * (max_size + 1) * sizeof(nid_int));
+    g->ghosts        = NULL;
     g->m             = create_matching(max_size / 2);
 
-    g->local_degree  = 0;
-    g->max_size      = max_size;
-    g->global_degree = global_size;
+    g->local_degree    = 0;
+    g->alive           = 0;
+    g->frontier_length = 0;
+    g->moved_length    = 0;
+    g->ghosts_length   = 0;
+    g->guessed         = 0;
+    g->max_size        = max_size;
+    g->global_degree   = global_size;
+
+    // Threads can't ask the BSP library who they are, so remember it here.
+    g->pid           = bsp_pid();
+    g->processes     = bsp_nprocs();
 
     return g;
 }
 
 /** PRIVATE
- * Determine in to which process a given node ID belongs.
- * 
+ * Check whether an edge of a node was removed.
+ *
  * Parameters:
- * - `g`        Pointer to this process' graph structure.
- * - `n`        Unique node identifier.
+ * - `nd`       Pointer to the node structure.
+ * - `i`        Position of the edge in the connections of the node.
  *
- * Returns:     The process that node `n` belongs to.
+ * Returns:     Whether the edge was removed.
  */
-uint belongs_to_proc(struct graph *g, nid_int n) {
-    return divide(n, g->global_degree, bsp_nprocs());
+bool edge_removed(struct node *nd, nid_int i) {
+    return nd->removed != NULL && ((nd->removed[i / 64] >> (i % 64)) & 1);
+}
+
+/** PRIVATE
+ * Give an edge a pseudo-random priority, which is the same for both of its
+ * endpoints and changes every round.
+ *
+ * Parameters:
+ * - `a`        Unique node identifier of one endpoint.
+ * - `b`        Unique node identifier of the other endpoint.
+ * - `round`    Round of the superstep loop.
+ *
+ * Returns:     Priority of the edge.
+ */
+unsigned long long edge_priority(nid_int a, nid_int b, nid_int round) {
+    unsigned long long low  = (a < b) ? a : b;
+    unsigned long long high = (a < b) ? b : a;
+
+    // The finalizer of SplitMix64, over both endpoints and the round.
+    unsigned long long x = (low * 0x9e3779b97f4a7c15ULL) ^ high;
+    x ^= ((unsigned long long) round + 1) * 0xd1b54a32d192ed03ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+    return x ^ (x >> 31);
+}
+
+/** PRIVATE
+ * Find the position of a neighbour in the connections of a node.
+ *
+ * Parameters:
+ * - `nd`       Pointer to the node structure.
+ * - `n`        Unique node identifier of the neighbour.
+ *
+ * Returns:     The position of the neighbour, or `nd->length` if the node
+ *              doesn't have it.
+ */
+nid_int find_edge(struct node *nd, nid_int n) {
+    nid_int low  = 0;
+    nid_int high = nd->length;
+
+    while (low < high) {
+        nid_int middle = low + (high - low) / 2;
+
+        if (nd->connections[nd->order[middle]] < n) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < nd->length && nd->connections[nd->order[low]] == n) {
+        return nd->order[low];
+    }
+    return nd->length;
 }
@@ -7,11 +7,12 @@
  *                  (sub)graph.
  * - `edges`        Array of edges that have at least one endpoint in this
  *                  (sub)graph.
+ * - `weights`      Weight of every edge, or NULL for an unweighted graph.
  *
  * Returns:         Pointer to a newly created graph structure.
  */
 struct graph *load_structure(nid_int total_nodes, nid_int local_edges, 
-                                                  nid_int (*edges)[2]);
+                             nid_int (*edges)[2], double *weights);
 
 /**
  * Create a node structure.
@@ -19,25 +20,119 @@ struct graph *load_structure(nid_int total_nodes, nid_int local_edges,
  * Parameters:
  * - `n`            Unique node identifier.
  * - `degree`       Array length of parameter `connections`.
+ * - `weighted`     Whether the connections have weights.
  */
-struct node *create_node(nid_int n, nid_int degree);
+struct node *create_node(nid_int n, nid_int degree, bool weighted);
+
+/**
+ * Check whether a given node belongs in this process.
+ * 
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `n`        Unique node identifier.
+ *
+ * Returns:     boolean whether the node identifier should be in this process.
+ */
+bool belongs_here(struct graph *g, nid_int n);
+
+/**
+ * Determine in to which process a given node ID belongs.
+ * 
+ * Parameters:
+ * - `g`        Pointer to this process' graph structure.
+ * - `n`        Unique node identifier.
+ *
+ * Returns:     The process that node `n` belongs to.
+ */
+uint belongs_to_proc(struct graph *g, nid_int n);
+
+/**
+ * Determine the index of a node in the graph.
+ *
+ * The index stays valid until the graph is compacted, even if other nodes are
+ * removed in the meantime.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `n`        Unique node identifier.
+ * - `index`    Pointer to the integer that stores the index.
+ *
+ * Returns:      /  0    if the node doesn't exist in the graph (yet) \
+ *               |  1    if the node was found                        |
+ *               \  2    if the node should be in a different process /
+ */
+nid_int index_of_node(struct graph* g, nid_int n, nid_int *index);
+
+/**
+ * Interpret all instructions that were received from other processes.
+ *
+ * DELETE instructions only change the node that they are addressed to, so
+ * they are spread across threads by that node. Every other instruction is
+ * interpreted in order afterwards.
+ *
+ * Parameters:
+ * - `todo`         Todo structure that tracks optional instructions.
+ * - `g`            Graph structure.
+ * - `inss`         Array of received instructions.
+ * - `inss_length`  Array length of parameter `inss`.
+ */
+void interpret_instructions(struct todo_list *todo, struct graph *g,
+                            struct instruction *inss, nid_int inss_length);
 
 /**
  * Remove an edge from a node.
  *
+ * A removal takes O(log d) time for a node of degree d: `find_edge()` finds
+ * the edge through binary search in `order`, and the edge is only marked as
+ * removed. Once half of the connections are removed, they are dropped from
+ * the array, which takes constant amortized time per removal. The degree
+ * only changes if the node still had the edge, and then the node joins the
+ * frontier of the next pass.
+ *
  * Parameters:
+ * - `g`        Graph structure.
  * - `nd`       Pointer to the node structure.
  * - `n`        Unique node identifier that needs to be removed.
  */
-void remove_edge(struct node *nd, nid_int n);
+void remove_edge(struct graph *g, struct node *nd, nid_int n);
 
 /**
- * Remove nodes from the graph that have a degree of 0.
+ * Drop the removed edges of a node from its connections, so that its first
+ * `degree` connections are exactly its neighbours. The connections keep
+ * their order.
+ *
+ * Every function that reads the connections of a node calls this first.
+ *
+ * Parameters:
+ * - `nd`       Pointer to the node structure.
+ */
+void compact_edges(struct node *nd);
+
+/**
+ * Remove nodes from the graph that have a degree of 0. Only the given nodes
+ * are looked at, as other nodes can't have lost an edge.
+ *
+ * The nodes are only marked as removed. The graph is compacted later, by
+ * `remove_singletons()`.
+ *
+ * Parameters:
+ * - `g`            Graph structure.
+ * - `nodes`        Unique node identifiers of the nodes to look at.
+ * - `nodes_length` Array length of parameter `nodes`.
+ */
+void remove_empty_nodes(struct graph *g, nid_int *nodes, nid_int nodes_length);
+
+/**
+ * Drop the removed nodes from the vertex array, so that every entry up to
+ * `local_degree` is a node. The nodes keep their order.
+ *
+ * This changes the indices of the nodes, so nobody may hold on to an index
+ * of `index_of_node()` across this call.
  *
  * Parameters:
  * - `g`        Graph structure.
  */
-void remove_empty_nodes(struct graph *g);
+void compact_graph(struct graph *g);
 
 /**
  * Remove a node from the graph.
@@ -49,6 +144,73 @@ void remove_empty_nodes(struct graph *g);
  */
 void remove_node(struct todo_list *todo, struct graph *g, nid_int n);
 
+/**
+ * Match the locally dominant edges of the graph, for when no singletons are
+ * left anywhere. Every node picks the edge with the highest random priority
+ * among its own edges, and two nodes that pick each other are matched.
+ *
+ * In a weighted graph, every node picks its heaviest edge instead, and the
+ * priority only breaks ties. Calling this function until no edges are left
+ * then gives a matching of at least half the maximum weight.
+ *
+ * The matched nodes are removed, which may create new singletons. The
+ * instructions for their neighbours in other processes are added to `todo`.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `todo`     Todo structure that tracks optional instructions.
+ * - `g`        Graph structure.
+ * - `round`    Round of the superstep loop, which chooses the priorities.
+ *
+ * Returns:     Whether any process still had an edge.
+ */
+bool match_dominant_edges(struct todo_list *todo, struct graph *g,
+                          nid_int round);
+
+/**
+ * Index the edges of this process to nodes of other processes, so that
+ * `remove_ghost()` can find them. Until then, `remove_ghost()` does nothing.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ */
+void index_ghosts(struct graph *g);
+
+/**
+ * Remove the edges of this process to a node of another process, before
+ * that process sends the instructions to delete them. This only works after
+ * `index_ghosts()`, and the later instructions then change nothing.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `n`        Unique node identifier of the node in another process.
+ */
+void remove_ghost(struct graph *g, nid_int n);
+
+/**
+ * Add a node to the frontier: the nodes whose degree changed since the last
+ * pass of `remove_singletons()` looked at them. A node is only added once.
+ *
+ * Threads may call this function at the same time for different nodes.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `nd`       Pointer to the node structure.
+ */
+void activate_node(struct graph *g, struct node *nd);
+
+/**
+ * Remove the node at an index from the graph, and free it. Its entry is
+ * marked as removed instead of closing the gap, so that the indices of other
+ * nodes stay valid until `compact_graph()`.
+ *
+ * Parameters:
+ * - `g`        Graph structure.
+ * - `index`    Index of the node.
+ */
+void tombstone_node(struct graph *g, nid_int index);
+
 /**
  * Erase the graph structure from memory.
  *
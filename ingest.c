@@ -0,0 +1,551 @@
+#include "divide.h"
+#include "ingest.h"
+#include "stats.h"
+#include "utilities.h"
+
+// PRIVATE FUNCTIONS
+struct id_table *create_id_table(nid_int expected);
+nid_int (*distribute_edges(nid_int (*edges)[2], nid_int edges_length,
+                           nid_int total_nodes, nid_int *local_length))[2];
+void *exchange_blocks(const void *items, size_t item_size, nid_int *counts,
+                      nid_int *received);
+uint id_owner(xid_int id, uint processes);
+nid_int insert_id(struct id_table *table, xid_int id);
+struct id_dictionary *remap_across_processes(xid_int (*edges)[2],
+                                             nid_int edges_length,
+                                             nid_int (*dense)[2]);
+void unallocate_id_table(struct id_table *table);
+
+/**
+ * Load a graph with sparse vertex IDs into the processes, with dense IDs.
+ *
+ * The first process spreads the edges evenly across all processes. Every
+ * original ID is then hashed to the process that owns it in the dictionary,
+ * which gives it a dense ID. Finally, every edge is sent to the processes
+ * that `divide()` assigns its dense endpoints to.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `input`        Graph to match. Only the first process reads it.
+ * - `total_nodes`  Integer that will store the amount of distinct vertices.
+ * - `local_length` Integer that will store the amount of edges of this
+ *                  process.
+ * - `dict`         Pointer that will store the part of the dictionary that
+ *                  this process owns.
+ *
+ * Returns:         Array of the edges of this process, with dense IDs.
+ */
+nid_int (*ingest_sparse_edges(const struct input_graph *input,
+                              nid_int *total_nodes, nid_int *local_length,
+                              struct id_dictionary **dict))[2] {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    // The first process gives every process an equal share of the edges.
+    nid_int *counts   = calloc(n, sizeof(nid_int));
+    nid_int *received = malloc(n * sizeof(nid_int));
+
+    if (p == 0) {
+        for (uint q=0; q<n; q++) {
+            counts[q] = (nid_wide) (q + 1) * input->edges_length / n -
+                        (nid_wide) q * input->edges_length / n;
+        }
+    }
+
+    xid_int (*share)[2] = exchange_blocks(
+        (p == 0) ? input->sparse_edges : NULL, sizeof(xid_int[2]),
+        counts, received
+    );
+    nid_int share_length = sum(received, n);
+
+    free(counts);
+    free(received);
+
+    // Give every vertex a dense ID.
+    nid_int (*dense)[2] = malloc((share_length + 1) * sizeof(nid_int[2]));
+
+    *dict = remap_across_processes(share, share_length, dense);
+    free(share);
+
+    *total_nodes = (*dict)->offsets[n];
+
+    // Send the edges to the processes of their endpoints.
+    nid_int (*edges)[2] = distribute_edges(dense, share_length, *total_nodes,
+                                           local_length);
+    free(dense);
+
+    return edges;
+}
+
+/**
+ * Look up the original IDs of the matches of this process.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `dict`     Part of the dictionary that this process owns.
+ * - `m`        Matching structure of this process, with dense IDs.
+ *
+ * Returns:     Array of the matches, with original IDs.
+ */
+xid_int (*restore_ids(struct id_dictionary *dict, struct matching *m))[2] {
+    uint n = bsp_nprocs();
+
+    nid_int endpoints = 2 * m->length;
+    nid_int *matched  = (nid_int *) m->matches;
+
+    // Ask the owner of every endpoint for its original ID. The requests are
+    // grouped by owner, and `position` remembers where each one went.
+    nid_int *counts   = calloc(n + 1, sizeof(nid_int));
+    nid_int *received = malloc(n * sizeof(nid_int));
+    uint    *owner    = malloc((endpoints + 1) * sizeof(uint));
+    nid_int *position = malloc((endpoints + 1) * sizeof(nid_int));
+    nid_int *requests = malloc((endpoints + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<endpoints; i++) {
+        // The owner is the last process whose range starts at or before the
+        // dense ID.
+        uint low  = 0;
+        uint high = n;
+
+        while (high - low > 1) {
+            uint middle = (low + high) / 2;
+
+            if (dict->offsets[middle] <= matched[i]) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+
+        owner[i] = low;
+        counts[low + 1]++;
+    }
+    for (uint q=1; q<=n; q++) {
+        counts[q] = counts[q] + counts[q-1];
+    }
+    for (nid_int i=0; i<endpoints; i++) {
+        position[i]           = counts[owner[i]]++;
+        requests[position[i]] = matched[i];
+    }
+
+    // After the grouping, each count holds the end of its group.
+    for (uint q=n-1; q>0; q--) {
+        counts[q] = counts[q] - counts[q-1];
+    }
+
+    nid_int *asked = exchange_blocks(requests, sizeof(nid_int), counts,
+                                     received);
+    nid_int asked_length = sum(received, n);
+
+    // Answer the requests of the other processes.
+    xid_int *answers = malloc((asked_length + 1) * sizeof(xid_int));
+
+    for (nid_int i=0; i<asked_length; i++) {
+        answers[i] = dict->ids[asked[i] - dict->offset];
+    }
+
+    // The answers come back in the order of the requests.
+    xid_int *found = exchange_blocks(answers, sizeof(xid_int), received,
+                                     counts);
+
+    xid_int (*restored)[2] = malloc((m->length + 1) * sizeof(xid_int[2]));
+    for (nid_int i=0; i<endpoints; i++) {
+        restored[i / 2][i % 2] = found[position[i]];
+    }
+
+    free(counts);
+    free(received);
+    free(owner);
+    free(position);
+    free(requests);
+    free(asked);
+    free(answers);
+    free(found);
+
+    return restored;
+}
+
+/**
+ * Give the vertices of a graph dense IDs on a single process.
+ *
+ * Parameters:
+ * - `edges`        Array of edges between arbitrary original vertex IDs.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `dense`        Array that will store the edges with dense IDs.
+ * - `ids`          Pointer that will store the original ID of every dense ID.
+ *
+ * Returns:         Amount of distinct vertices.
+ */
+nid_int remap_ids(xid_int (*edges)[2], nid_int edges_length,
+                  nid_int (*dense)[2], xid_int **ids) {
+    struct id_table *table = create_id_table(2 * edges_length);
+
+    for (nid_int i=0; i<edges_length; i++) {
+        dense[i][0] = insert_id(table, edges[i][0]);
+        dense[i][1] = insert_id(table, edges[i][1]);
+    }
+
+    nid_int length = table->length;
+
+    // The caller keeps the list of original IDs.
+    *ids       = table->ids;
+    table->ids = NULL;
+    unallocate_id_table(table);
+
+    return length;
+}
+
+/**
+ * Unallocate the dictionary between dense and original vertex IDs.
+ *
+ * Parameters:
+ * - `dict`     The dictionary that is to be freed from memory.
+ */
+void unallocate_id_dictionary(struct id_dictionary *dict) {
+    free(dict->ids);
+    free(dict->offsets);
+    free(dict);
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Create an empty hash table for original vertex IDs.
+ *
+ * Parameters:
+ * - `expected`     Largest amount of distinct IDs that will be inserted.
+ *
+ * Returns:         Pointer to a newly created hash table.
+ */
+struct id_table *create_id_table(nid_int expected) {
+    struct id_table *table = malloc(sizeof(struct id_table));
+
+    // At most half of the slots are in use, which keeps the probes short.
+    table->capacity = 2;
+    while (table->capacity < 2 * expected) {
+        table->capacity = 2 * table->capacity;
+    }
+
+    table->keys   = malloc(table->capacity * sizeof(xid_int));
+    table->values = malloc(table->capacity * sizeof(nid_int));
+    table->ids    = malloc((expected + 1) * sizeof(xid_int));
+    table->length = 0;
+
+    for (nid_int i=0; i<table->capacity; i++) {
+        table->values[i] = NO_MATE;
+    }
+
+    return table;
+}
+
+/** PRIVATE
+ * Send the edges to the processes that `divide()` assigns their endpoints to.
+ * An edge between two processes goes to both of them.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `edges`        Array of edges of this process, with dense IDs.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `total_nodes`  Amount of vertices in the graph.
+ * - `local_length` Integer that will store the amount of received edges.
+ *
+ * Returns:         Array of the received edges.
+ */
+nid_int (*distribute_edges(nid_int (*edges)[2], nid_int edges_length,
+                           nid_int total_nodes, nid_int *local_length))[2] {
+    uint n = bsp_nprocs();
+
+    nid_int *counts   = calloc(n + 1, sizeof(nid_int));
+    nid_int *received = malloc(n * sizeof(nid_int));
+
+    for (nid_int i=0; i<edges_length; i++) {
+        uint p1 = divide(edges[i][0], total_nodes, n);
+        uint p2 = divide(edges[i][1], total_nodes, n);
+
+        counts[p1 + 1]++;
+        if (p2 != p1) {
+            counts[p2 + 1]++;
+        }
+    }
+
+    // Group the edges by process.
+    for (uint q=1; q<=n; q++) {
+        counts[q] = counts[q] + counts[q-1];
+    }
+
+    nid_int (*grouped)[2] = malloc((counts[n] + 1) * sizeof(nid_int[2]));
+
+    for (nid_int i=0; i<edges_length; i++) {
+        uint p1 = divide(edges[i][0], total_nodes, n);
+        uint p2 = divide(edges[i][1], total_nodes, n);
+
+        grouped[counts[p1]][0] = edges[i][0];
+        grouped[counts[p1]][1] = edges[i][1];
+        counts[p1]++;
+
+        if (p2 != p1) {
+            grouped[counts[p2]][0] = edges[i][0];
+            grouped[counts[p2]][1] = edges[i][1];
+            counts[p2]++;
+        }
+    }
+
+    // After the grouping, each count holds the end of its group.
+    for (uint q=n-1; q>0; q--) {
+        counts[q] = counts[q] - counts[q-1];
+    }
+
+    nid_int (*local)[2] = exchange_blocks(grouped, sizeof(nid_int[2]),
+                                          counts, received);
+    *local_length = sum(received, n);
+
+    free(counts);
+    free(received);
+    free(grouped);
+
+    return local;
+}
+
+/** PRIVATE
+ * Send a block of items to every process, and receive a block from every
+ * process.
+ *
+ * The received blocks follow each other in order of PID. If every process
+ * answers each received item in place and sends the answers back with the
+ * received amounts as counts, the answers arrive in the order of the
+ * original items.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `items`        Items to send, grouped by process in order of PID.
+ * - `item_size`    Size in bytes of an item.
+ * - `counts`       Amount of items that this process sends to every process.
+ * - `received`     Array that will store the amount of items that every
+ *                  process sent to this process.
+ *
+ * Returns:         Array of the received items.
+ */
+void *exchange_blocks(const void *items, size_t item_size, nid_int *counts,
+                      nid_int *received) {
+    uint n = bsp_nprocs();
+
+    // Find where the block of every process starts in the array of its
+    // destination.
+    nid_int *starts = malloc(n * sizeof(nid_int));
+    nid_int total   = 0;
+
+    memcpy(received, counts, n * sizeof(nid_int));
+    exchange_numbers_all_to_all(received);
+
+    for (uint q=0; q<n; q++) {
+        starts[q] = total;
+        total     = total + received[q];
+    }
+    exchange_numbers_all_to_all(starts);
+
+    char *buffer = local_malloc(total * item_size + 1);
+    bsp_push_reg(buffer, total * item_size);
+    counted_sync();
+
+    size_t offset = 0;
+    for (uint q=0; q<n; q++) {
+        if (counts[q] > 0) {
+            counted_put(q, (const char *) items + offset, buffer,
+                        starts[q] * item_size, counts[q] * item_size);
+            offset = offset + counts[q] * item_size;
+        }
+    }
+    counted_sync();
+    bsp_pop_reg(buffer);
+
+    free(starts);
+    return buffer;
+}
+
+/** PRIVATE
+ * Find the process that owns an original vertex ID in the dictionary.
+ *
+ * The ID is scrambled first, so that IDs that share a pattern still spread
+ * evenly across the processes.
+ *
+ * Parameters:
+ * - `id`           Original vertex ID.
+ * - `processes`    Amount of processes in the program.
+ *
+ * Returns:         The process that owns the ID.
+ */
+uint id_owner(xid_int id, uint processes) {
+    // The finalizer of SplitMix64.
+    id = (id ^ (id >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    id = (id ^ (id >> 27)) * 0x94d049bb133111ebULL;
+    id =  id ^ (id >> 31);
+
+    return id % processes;
+}
+
+/** PRIVATE
+ * Find the dense index of an original vertex ID, and give it the next index
+ * if the table doesn't contain it yet.
+ *
+ * Parameters:
+ * - `table`    Hash table.
+ * - `id`       Original vertex ID.
+ *
+ * Returns:     The dense index of the ID.
+ */
+nid_int insert_id(struct id_table *table, xid_int id) {
+    // Linear probing from a multiplicative hash.
+    nid_int mask = table->capacity - 1;
+    nid_int slot = (nid_int) ((id * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+
+    while (table->values[slot] != NO_MATE) {
+        if (table->keys[slot] == id) {
+            return table->values[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    table->keys[slot]              = id;
+    table->values[slot]            = table->length;
+    table->ids[table->length]      = id;
+    table->length++;
+
+    return table->values[slot];
+}
+
+/** PRIVATE
+ * Give every vertex of the edges of all processes a dense ID. Every process
+ * owns the original IDs that hash to it, and numbers them in the order in
+ * which they arrive. The dense IDs of a process follow those of the processes
+ * with a lower PID, so that they roughly match the block of `divide()`.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `edges`        Array of edges of this process, with original IDs.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `dense`        Array that will store the edges with dense IDs.
+ *
+ * Returns:         The part of the dictionary that this process owns.
+ */
+struct id_dictionary *remap_across_processes(xid_int (*edges)[2],
+                                             nid_int edges_length,
+                                             nid_int (*dense)[2]) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    // Only ask once for every distinct ID of this process. For now, `dense`
+    // holds the local index of every endpoint.
+    struct id_table *local = create_id_table(2 * edges_length);
+
+    for (nid_int i=0; i<edges_length; i++) {
+        dense[i][0] = insert_id(local, edges[i][0]);
+        dense[i][1] = insert_id(local, edges[i][1]);
+    }
+
+    // Group the distinct IDs by owner.
+    nid_int *counts   = calloc(n + 1, sizeof(nid_int));
+    nid_int *received = malloc(n * sizeof(nid_int));
+    nid_int *position = malloc((local->length + 1) * sizeof(nid_int));
+    xid_int *requests = malloc((local->length + 1) * sizeof(xid_int));
+
+    for (nid_int i=0; i<local->length; i++) {
+        counts[id_owner(local->ids[i], n) + 1]++;
+    }
+    for (uint q=1; q<=n; q++) {
+        counts[q] = counts[q] + counts[q-1];
+    }
+    for (nid_int i=0; i<local->length; i++) {
+        position[i]           = counts[id_owner(local->ids[i], n)]++;
+        requests[position[i]] = local->ids[i];
+    }
+
+    // After the grouping, each count holds the end of its group.
+    for (uint q=n-1; q>0; q--) {
+        counts[q] = counts[q] - counts[q-1];
+    }
+
+    xid_int *asked = exchange_blocks(requests, sizeof(xid_int), counts,
+                                     received);
+    nid_int asked_length = sum(received, n);
+
+    // Number the IDs that this process owns.
+    struct id_table *owned = create_id_table(asked_length);
+    nid_int *answers       = malloc((asked_length + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<asked_length; i++) {
+        answers[i] = insert_id(owned, asked[i]);
+    }
+
+    // Place the numbers of this process after those of lower PIDs.
+    struct id_dictionary *dict = malloc(sizeof(struct id_dictionary));
+    dict->offsets = malloc((n + 1) * sizeof(nid_int));
+
+    for (uint q=0; q<n; q++) {
+        dict->offsets[q] = owned->length;
+    }
+    exchange_numbers_all_to_all(dict->offsets);
+
+    nid_int total = 0;
+    for (uint q=0; q<=n; q++) {
+        nid_int length   = (q < n) ? dict->offsets[q] : 0;
+        dict->offsets[q] = total;
+        total            = total + length;
+    }
+
+    dict->offset = dict->offsets[p];
+    dict->length = owned->length;
+    dict->ids    = owned->ids;
+    owned->ids   = NULL;
+
+    for (nid_int i=0; i<asked_length; i++) {
+        answers[i] = answers[i] + dict->offset;
+    }
+
+    // The answers come back in the order of the requests.
+    nid_int *found = exchange_blocks(answers, sizeof(nid_int), received,
+                                     counts);
+
+    for (nid_int i=0; i<edges_length; i++) {
+        dense[i][0] = found[position[dense[i][0]]];
+        dense[i][1] = found[position[dense[i][1]]];
+    }
+
+    unallocate_id_table(local);
+    unallocate_id_table(owned);
+    free(counts);
+    free(received);
+    free(position);
+    free(requests);
+    free(asked);
+    free(answers);
+    free(found);
+
+    return dict;
+}
+
+/** PRIVATE
+ * Unallocate a hash table of original vertex IDs.
+ *
+ * Parameters:
+ * - `table`    The hash table that is to be freed from memory.
+ */
+void unallocate_id_table(struct id_table *table) {
+    free(table->keys);
+    free(table->values);
+    free(table->ids);
+    free(table);
+}
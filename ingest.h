@@ -0,0 +1,59 @@
+
+/**
+ * Load a graph with sparse vertex IDs into the processes, with dense IDs.
+ *
+ * The first process spreads the edges evenly across all processes. Every
+ * original ID is then hashed to the process that owns it in the dictionary,
+ * which gives it a dense ID. Finally, every edge is sent to the processes
+ * that `divide()` assigns its dense endpoints to.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `input`        Graph to match. Only the first process reads it.
+ * - `total_nodes`  Integer that will store the amount of distinct vertices.
+ * - `local_length` Integer that will store the amount of edges of this
+ *                  process.
+ * - `dict`         Pointer that will store the part of the dictionary that
+ *                  this process owns.
+ *
+ * Returns:         Array of the edges of this process, with dense IDs.
+ */
+nid_int (*ingest_sparse_edges(const struct input_graph *input,
+                              nid_int *total_nodes, nid_int *local_length,
+                              struct id_dictionary **dict))[2];
+
+/**
+ * Look up the original IDs of the matches of this process.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `dict`     Part of the dictionary that this process owns.
+ * - `m`        Matching structure of this process, with dense IDs.
+ *
+ * Returns:     Array of the matches, with original IDs.
+ */
+xid_int (*restore_ids(struct id_dictionary *dict, struct matching *m))[2];
+
+/**
+ * Give the vertices of a graph dense IDs on a single process.
+ *
+ * Parameters:
+ * - `edges`        Array of edges between arbitrary original vertex IDs.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `dense`        Array that will store the edges with dense IDs.
+ * - `ids`          Pointer that will store the original ID of every dense ID.
+ *
+ * Returns:         Amount of distinct vertices.
+ */
+nid_int remap_ids(xid_int (*edges)[2], nid_int edges_length,
+                  nid_int (*dense)[2], xid_int **ids);
+
+/**
+ * Unallocate the dictionary between dense and original vertex IDs.
+ *
+ * Parameters:
+ * - `dict`     The dictionary that is to be freed from memory.
+ */
+void unallocate_id_dictionary(struct id_dictionary *dict);
@@ -3,6 +3,9 @@
 #include <stdbool.h>
 
 #include "instructions.h"
+#include "placement.h"
+#include "stats.h"
+#include "trace.h"
 #include "utilities.h"
 
 // PRIVATE FUNCTIONS
@@ -12,6 +15,104 @@ struct instruction *instruction_keep_alive(void);
 void keep_todo_list_alive(struct todo_list *todo);
 void unallocate_instruction(struct instruction *ins);
 
+/**
+ * Create the instruction to add an edge to a small component.
+ *
+ * This instruction is sent to the process that solves the component.
+ *
+ * Parameters:
+ * - `node_one`     Unique node identifier of the first endpoint.
+ * - `node_two`     Unique node identifier of the second endpoint.
+ *
+ * Returns:         Instruction to add the edge.
+ */
+struct instruction *instruction_component_edge(nid_int node_one,
+                                               nid_int node_two) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = COMPONENT_EDGE;
+    ins->next  = NULL;
+    ins->content[0] = node_one;
+    ins->content[1] = node_two;
+    ins->content[2] = 0;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
+/**
+ * Create the instruction to spread a component label to a node.
+ *
+ * Parameters:
+ * - `nid`          Node identifier that receives the label.
+ * - `label`        Smallest node identifier known in the node's component.
+ *
+ * Returns:         Instruction to update the label.
+ */
+struct instruction *instruction_component_label(nid_int nid, nid_int label) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = COMPONENT_LABEL;
+    ins->next  = NULL;
+    ins->content[0] = nid;
+    ins->content[1] = label;
+    ins->content[2] = 0;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
+/**
+ * Create the instruction to report a part of a component to its root.
+ *
+ * Parameters:
+ * - `label`        Component label, which is also the root's identifier.
+ * - `vertices`     Amount of vertices of the component in this process.
+ * - `pid`          Process that sends the report.
+ *
+ * Returns:         Instruction to report the component size.
+ */
+struct instruction *instruction_component_size(nid_int label, 
+                                               nid_int vertices,
+                                               nid_int pid) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = COMPONENT_SIZE;
+    ins->next  = NULL;
+    ins->content[0] = label;
+    ins->content[1] = vertices;
+    ins->content[2] = pid;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
+/**
+ * Create the instruction to tell a process how a component will be solved.
+ *
+ * Parameters:
+ * - `label`        Component label.
+ * - `small`        1 if the component is solved on a single process,
+ *                  0 if it goes through the distributed supersteps.
+ * - `target`       Process that solves the component if it is small.
+ *
+ * Returns:         Instruction with the verdict.
+ */
+struct instruction *instruction_component_verdict(nid_int label, 
+                                                  nid_int small,
+                                                  nid_int target) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = COMPONENT_VERDICT;
+    ins->next  = NULL;
+    ins->content[0] = label;
+    ins->content[1] = small;
+    ins->content[2] = target;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
 /**
  * Create the instruction to concatenate a snake.
  *
@@ -109,6 +210,28 @@ struct instruction *instruction_move_node(nid_int nid, nid_int neighbour) {
     return ins;
 }
 
+/**
+ * Create the instruction to propose a match to a node in another process.
+ *
+ * Parameters:
+ * - `nid`          Node identifier that proposes the match.
+ * - `partner`      Node identifier of the node that it proposes to.
+ *
+ * Returns:         Instruction to propose the match.
+ */
+struct instruction *instruction_propose_match(nid_int nid, nid_int partner) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = PROPOSE;
+    ins->next  = NULL;
+    ins->content[0] = nid;
+    ins->content[1] = partner;
+    ins->content[2] = 0;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
 /**
  * Create the instruction to reverse a multi-process snake.
  *
@@ -132,6 +255,75 @@ struct instruction *instruction_reverse_snake(nid_int snake_base,
     return ins;
 }
 
+/**
+ * Create the instruction to tell a process that the partner of one of its
+ * vertices has no other neighbours.
+ *
+ * Parameters:
+ * - `nid`          Node identifier whose partner is a leaf.
+ * - `leaf`         The partner.
+ *
+ * Returns:         Instruction to report the leaf.
+ */
+struct instruction *instruction_validate_leaf(nid_int nid, nid_int leaf) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = VALIDATE_LEAF;
+    ins->next  = NULL;
+    ins->content[0] = nid;
+    ins->content[1] = leaf;
+    ins->content[2] = 0;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
+/**
+ * Create the instruction to tell a process that a neighbour of one of its
+ * vertices has not been matched.
+ *
+ * Parameters:
+ * - `nid`          Node identifier with a free neighbour.
+ * - `neighbour`    The free neighbour.
+ *
+ * Returns:         Instruction to report the free neighbour.
+ */
+struct instruction *instruction_validate_free(nid_int nid, nid_int neighbour) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = VALIDATE_FREE;
+    ins->next  = NULL;
+    ins->content[0] = nid;
+    ins->content[1] = neighbour;
+    ins->content[2] = 0;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
+/**
+ * Create the instruction to report a match to the process of one of its
+ * vertices.
+ *
+ * Parameters:
+ * - `nid`          Node identifier in the process that receives it.
+ * - `partner`      Node identifier that `nid` was matched with.
+ *
+ * Returns:         Instruction to report the match.
+ */
+struct instruction *instruction_validate_match(nid_int nid, nid_int partner) {
+    struct instruction *ins = malloc(sizeof(struct instruction));
+
+    ins->value = VALIDATE_MATCH;
+    ins->next  = NULL;
+    ins->content[0] = nid;
+    ins->content[1] = partner;
+    ins->content[2] = 0;
+    ins->content[3] = 0;
+
+    return ins;
+}
+
 /**
  * Send all registered instructions to the respective processes.
  *
@@ -147,11 +339,11 @@ struct instruction *send_instructions(struct todo_list *todo) {
 
     nid_int *offsets = exchange_instruction_offsets(todo);
 
-    bsp_sync();
-    unsigned int mem_size = todo->expected_responses * sizeof(struct instruction);
-    struct instruction *inss = malloc(mem_size);
+    counted_sync();
+    size_t mem_size = todo->expected_responses * sizeof(struct instruction);
+    struct instruction *inss = local_malloc(mem_size);
     bsp_push_reg(inss, mem_size);
-    bsp_sync();
+    counted_sync();
     
     for (uint i=0; i<n; i++) {
         nid_int ins_length      = todo->length[i];
@@ -159,14 +351,14 @@ struct instruction *send_instructions(struct todo_list *todo) {
         struct instruction *ins = todo->p_list[i];
 
         for (nid_int j=0; j<ins_length; j++) {
-            bsp_put(i, ins, inss, (offset+j)*sizeof(struct instruction), 
-                    sizeof(struct instruction));
+            counted_put(i, ins, inss, (offset+j)*sizeof(struct instruction), 
+                        sizeof(struct instruction));
             ins = ins->next;
         }
     }
     free(offsets);
 
-    bsp_sync();
+    counted_sync();
     bsp_pop_reg(inss);
 
     return inss;
@@ -246,6 +438,38 @@ void add_instruction(struct instruction *ins, struct todo_list *todo, uint p) {
     todo->length[p]++;
 }
 
+/**
+ * Move all instructions of one todo list to the end of another.
+ *
+ * The emptied todo list can safely be unallocated afterwards.
+ *
+ * Parameters:
+ * - `todo`     todo_list structure that receives the instructions.
+ * - `other`    todo_list structure that is emptied.
+ */
+void merge_todo_lists(struct todo_list *todo, struct todo_list *other) {
+    uint n = bsp_nprocs();
+
+    for (uint i=0; i<n; i++) {
+        if (other->length[i] == 0) {
+            continue;
+        }
+
+        if (todo->length[i] == 0) {
+            todo->p_list[i] = other->p_list[i];
+        } else {
+            todo->latest[i]->next = other->p_list[i];
+        }
+
+        todo->latest[i] = other->latest[i];
+        todo->length[i] = todo->length[i] + other->length[i];
+
+        other->length[i] = 0;
+        other->p_list[i] = NULL;
+        other->latest[i] = NULL;
+    }
+}
+
 /**
  * Send an instruction to stdout.
  *
@@ -264,12 +488,20 @@ void show_instruction(struct instruction ins) {
     else if (value == 3) {printf("INHERIT     ");}
     else if (value == 4) {printf("REVERSE     ");}
     else if (value == 5) {printf("CONCATENATE ");}
+    else if (value == 6) {printf("COMP_LABEL  ");}
+    else if (value == 7) {printf("COMP_SIZE   ");}
+    else if (value == 8) {printf("COMP_VERDICT");}
+    else if (value == 9) {printf("COMP_EDGE   ");}
+    else if (value == 10) {printf("VAL_MATCH   ");}
+    else if (value == 11) {printf("VAL_FREE    ");}
+    else if (value == 12) {printf("VAL_LEAF    ");}
+    else if (value == 13) {printf("PROPOSE     ");}
     else                 {printf("UNKNOWN     ");}
 
     printf("[ ");
     unsigned short int content_length = sizeof(ins.content) / sizeof(nid_int);
     for (unsigned short int i=0; i<content_length; i++) {
-        printf("%u ", ins.content[i]);
+        printf(NID_FORMAT " ", ins.content[i]);
     }
 
     printf("] >\n");
@@ -354,22 +586,9 @@ nid_int *exchange_instruction_offsets(struct todo_list *todo) {
         numbers[i] = todo->length[i];
     }
 
-    // DEBUG: Get a message matrix
-    bsp_sync();
-    for (uint i=0; i<n; i++) {
-        if (i == bsp_pid()) {
-            if (i == 0) {
-                printf("This is how many messages each process sends to each other process:\n");
-            }
-            printf("[ ");
-            for (uint i=0; i<n; i++) {
-                numbers[i] = todo->length[i];
-                printf("%u ", numbers[i]);
-            }
-            printf("]\n");
-        }
-        bsp_sync();
-    }
+#if TRACE_LEVEL >= TRACE_ROUNDS
+    trace_numbers("Messages to each process", numbers, n);
+#endif
 
     exchange_numbers_all_to_all(numbers);
 
@@ -466,12 +685,12 @@ void exchange_instruction_sizes(nid_int *numbers, nid_int value) {
     uint p = bsp_pid();
 
     bsp_push_reg(numbers, n*sizeof(nid_int));
-    bsp_sync();
+    counted_sync();
 
     for (uint i=0; i<n; i++) {
-        bsp_put(i, &value, numbers, p*sizeof(nid_int), sizeof(nid_int));
+        counted_put(i, &value, numbers, p*sizeof(nid_int), sizeof(nid_int));
     }
-    bsp_sync();
+    counted_sync();
 
     bsp_pop_reg(numbers);
 }
@@ -492,15 +711,15 @@ void exchange_instructions(struct instruction **tasks, nid_int *task_length) {
 
     struct instruction *new_instructions = malloc(total_size * sizeof(struct instruction));
     bsp_push_reg(new_instructions, total_size*sizeof(struct instruction));
-    bsp_sync();
+    counted_sync();
 
     // Exchange instructions
     for (uint i=0; i<n; i++) {
         for (nid_int j=0; j<*task_length; j++) {
-            bsp_put(i, tasks[j], new_instructions, offset+j*sizeof(struct instruction), sizeof(struct instruction));
+            counted_put(i, tasks[j], new_instructions, offset+j*sizeof(struct instruction), sizeof(struct instruction));
         }
     }
-    bsp_sync();
+    counted_sync();
     bsp_pop_reg(new_instructions);
 
 
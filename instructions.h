@@ -1,4 +1,57 @@
 
+/**
+ * Create the instruction to add an edge to a small component.
+ *
+ * This instruction is sent to the process that solves the component.
+ *
+ * Parameters:
+ * - `node_one`     Unique node identifier of the first endpoint.
+ * - `node_two`     Unique node identifier of the second endpoint.
+ *
+ * Returns:         Instruction to add the edge.
+ */
+struct instruction *instruction_component_edge(nid_int node_one,
+                                               nid_int node_two);
+
+/**
+ * Create the instruction to spread a component label to a node.
+ *
+ * Parameters:
+ * - `nid`          Node identifier that receives the label.
+ * - `label`        Smallest node identifier known in the node's component.
+ *
+ * Returns:         Instruction to update the label.
+ */
+struct instruction *instruction_component_label(nid_int nid, nid_int label);
+
+/**
+ * Create the instruction to report a part of a component to its root.
+ *
+ * Parameters:
+ * - `label`        Component label, which is also the root's identifier.
+ * - `vertices`     Amount of vertices of the component in this process.
+ * - `pid`          Process that sends the report.
+ *
+ * Returns:         Instruction to report the component size.
+ */
+struct instruction *instruction_component_size(nid_int label, 
+                                               nid_int vertices,
+                                               nid_int pid);
+
+/**
+ * Create the instruction to tell a process how a component will be solved.
+ *
+ * Parameters:
+ * - `label`        Component label.
+ * - `small`        1 if the component is solved on a single process,
+ *                  0 if it goes through the distributed supersteps.
+ * - `target`       Process that solves the component if it is small.
+ *
+ * Returns:         Instruction with the verdict.
+ */
+struct instruction *instruction_component_verdict(nid_int label, 
+                                                  nid_int small,
+                                                  nid_int target);
 
 /**
  * Create the instruction to concatenate a snake.
@@ -53,6 +106,17 @@ struct instruction *instruction_inherit_node(nid_int snek_base,
  */
 struct instruction *instruction_move_node(nid_int nid, nid_int neighbour);
 
+/**
+ * Create the instruction to propose a match to a node in another process.
+ *
+ * Parameters:
+ * - `nid`          Node identifier that proposes the match.
+ * - `partner`      Node identifier of the node that it proposes to.
+ *
+ * Returns:         Instruction to propose the match.
+ */
+struct instruction *instruction_propose_match(nid_int nid, nid_int partner);
+
 /**
  * Create the instruction to reverse a multi-process snake.
  *
@@ -65,6 +129,42 @@ struct instruction *instruction_move_node(nid_int nid, nid_int neighbour);
 struct instruction *instruction_reverse_snake(nid_int snake_base, 
                                               nid_int snake_head);
 
+/**
+ * Create the instruction to tell a process that the partner of one of its
+ * vertices has no other neighbours.
+ *
+ * Parameters:
+ * - `nid`          Node identifier whose partner is a leaf.
+ * - `leaf`         The partner.
+ *
+ * Returns:         Instruction to report the leaf.
+ */
+struct instruction *instruction_validate_leaf(nid_int nid, nid_int leaf);
+
+/**
+ * Create the instruction to tell a process that a neighbour of one of its
+ * vertices has not been matched.
+ *
+ * Parameters:
+ * - `nid`          Node identifier with a free neighbour.
+ * - `neighbour`    The free neighbour.
+ *
+ * Returns:         Instruction to report the free neighbour.
+ */
+struct instruction *instruction_validate_free(nid_int nid, nid_int neighbour);
+
+/**
+ * Create the instruction to report a match to the process of one of its
+ * vertices.
+ *
+ * Parameters:
+ * - `nid`          Node identifier in the process that receives it.
+ * - `partner`      Node identifier that `nid` was matched with.
+ *
+ * Returns:         Instruction to report the match.
+ */
+struct instruction *instruction_validate_match(nid_int nid, nid_int partner);
+
 /**
  * Send all registered instructions to the respective processes.
  *
@@ -107,6 +207,17 @@ void add_global_instruction(struct instruction *ins, struct todo_list *todo);
  */
 void add_instruction(struct instruction *ins, struct todo_list *todo, uint p);
 
+/**
+ * Move all instructions of one todo list to the end of another.
+ *
+ * The emptied todo list can safely be unallocated afterwards.
+ *
+ * Parameters:
+ * - `todo`     todo_list structure that receives the instructions.
+ * - `other`    todo_list structure that is emptied.
+ */
+void merge_todo_lists(struct todo_list *todo, struct todo_list *other);
+
 /**
  * Send an instruction to stdout.
  *
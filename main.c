@@ -1,217 +1,205 @@
-#include <bsp.h>
-#include <stdbool.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#include "main.h"
-
-#include "debug.c"
-#include "divide.c"
-#include "graph.c"
-#include "instructions.c"
-#include "match.c"
-#include "steps.c"
-#include "utilities.c"
-
-static unsigned int AMOUNT_OF_CORES;
+#include "matcher.c"
 
 /**
-* Function that runs synchronously on multiple cores.
+* Setup function
 */
-void spmd() {
-    bsp_begin(AMOUNT_OF_CORES);
-    
-    /***********************************
-    *       INITIALIZATION PHASE       *
-    ************************************
-    *  Load the data that was created  *
-    *  for us during initialization.   *
-    ************************************/
-    uint n = bsp_nprocs();
-    uint p = bsp_pid();
-
-    nid_int edges_in_pid;   // Amount of edges in this process
-    
-    nid_int amountOfNodes;  // Amount of vertices in the graph
-    nid_int amountOfEdges;  // Amount of edges in the graph
-
-    bsp_push_reg(&edges_in_pid,  sizeof(nid_int));
-    bsp_push_reg(&amountOfNodes, sizeof(nid_int));
-
-    bsp_sync();
-
-
-
-    /* Step a)
-    **
-    ** Prompt how many vertices and edges the graph has,
-    ** and tell each process how many vertices to expect.
-    */
-    if (p == 0) {
-        prompt_graph_size(&amountOfNodes, &amountOfEdges);
-
-        broadcast_total_node_amount(&amountOfNodes);
+int main(int argc, char** argv) {
+    struct matcher_options options = default_matcher_options();
+    bool batch    = false;
+    bool sparse   = false;
+    bool weighted = false;
+    int option;
+
+    options.processes = 0;
+
+    // Read the command line options
+    //  -t <threads>    Amount of threads within each process.
+    //  -b <backend>    Either `bsp` (default) to match with BSP processes,
+    //                  or `shared` to match with threads in shared memory.
+    //  -c <cores>      Pin processes and threads to these cores, in order.
+    //                  For example: `0-3,8-11`.
+    //  -s <file>       Print the BSP cost of the run, and write the
+    //                  measurements of every superstep to a CSV file.
+    //  -j <file>       Write the phases of every process to a Chrome
+    //                  trace-event JSON file, to view them in Perfetto.
+    //  -p <processes>  Amount of processes. Without this option, the program
+    //                  asks for it on stdin.
+    //  -d <strategy>   Distribute vertices with `block` (default) or
+    //                  `cyclic` distribution.
+    //  -m <file>       Predict the BSP cost of -s with the machine parameters
+    //                  that the probe program measured.
+    //  -v              Validate the matching after the run, and report how
+    //                  far it can be from a maximum matching.
+    //  -o <file>       Write the matching to a file. With `%u` in the name,
+    //                  every process writes its own file.
+    //  -B              Batch mode: match every graph on stdin in a single
+    //                  session, and print the size of every matching.
+    //  -x              The vertex IDs are arbitrary 64-bit numbers, like
+    //                  hashes. The vertex count of the input is ignored, and
+    //                  -o writes the original IDs.
+    //  -w              Every edge has a weight after its vertices. The
+    //                  matcher looks for a matching of high weight instead
+    //                  of many edges, and prints its weight.
+    //  -q <target>     Anytime mode: stop once the matching has at least this
+    //                  fraction of the size of a maximum matching, like 0.99.
+    //                  Not with -w, as the bound counts edges, not weight.
+    //  -T <seconds>    Anytime mode: stop once the matching took this long.
+    //  -O              Optimistic mode: a process drops its edges to a node
+    //                  of another process as soon as it sends that node a
+    //                  singleton, instead of waiting a round.
+    while ((option = getopt(argc, argv, "t:b:c:s:j:p:d:m:vo:Bxwq:T:O")) != -1) {
+        if (option == 'O') {
+            options.optimistic = true;
+        } else if (option == 'q') {
+            options.quality_target = strtod(optarg, NULL);
+        } else if (option == 'T') {
+            options.time_budget = strtod(optarg, NULL);
+        } else if (option == 'w') {
+            weighted = true;
+        } else if (option == 'x') {
+            sparse = true;
+        } else if (option == 'B') {
+            batch = true;
+        } else if (option == 'o') {
+            options.output_path = optarg;
+        } else if (option == 'v') {
+            options.validate = true;
+        } else if (option == 'm') {
+            if (!load_bsp_parameters(optarg, &(options.g), &(options.l))) {
+                fprintf(stderr, "Cannot read the BSP parameters in %s.\n", optarg);
+                return EXIT_FAILURE;
+            }
+        } else if (option == 'p') {
+            options.processes = strtoul(optarg, NULL, 10);
+
+            if (options.processes == 0) {
+                fprintf(stderr, "Cannot start %s processes.\n", optarg);
+                return EXIT_FAILURE;
+            }
+        } else if (option == 'd') {
+            if (!parse_divide_strategy(optarg, &(options.divide))) {
+                fprintf(stderr, "Cannot distribute vertices by %s.\n", optarg);
+                return EXIT_FAILURE;
+            }
+        } else if (option == 's') {
+            options.stats_path = optarg;
+        } else if (option == 'j') {
+            options.timeline_path = optarg;
+        } else if (option == 'c') {
+            options.cores_length = parse_core_list(optarg, &(options.cores));
+
+            if (options.cores_length == 0) {
+                fprintf(stderr, "Cannot read the core list %s.\n", optarg);
+                return EXIT_FAILURE;
+            }
+        } else if (option == 't') {
+            options.threads = strtoul(optarg, NULL, 10);
+        } else if (option == 'b' && strcmp(optarg, "bsp") == 0) {
+            options.shared = false;
+        } else if (option == 'b' && strcmp(optarg, "shared") == 0) {
+            options.shared = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-t threads] [-b bsp|shared] [-c cores] [-s file] [-j file] [-p processes] [-d block|cyclic] [-m file] [-v] [-o file] [-B] [-x] [-w] [-q target] [-T seconds] [-O]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
     }
-    bsp_sync();
-
-
-
-    /* Step b)
-    **
-    ** Prompt all the edges between vertices. Temporarily store them
-    ** and calculate how many edges each process may expect.
-    */
-    nid_int (*edges)[2];
 
-    if (p == 0) {
-        edges = malloc(amountOfEdges * 2 * sizeof(nid_int));
-        
-        prompt_edges(edges, amountOfEdges);
-        broadcast_edge_amount(edges, amountOfEdges, amountOfNodes, 
-                              &edges_in_pid);
+    // Set up the processes
+    if (options.processes == 0) {
+        printf("How many processes would you like to use? There are %u cores available.\n", bsp_nprocs());
+        fflush(stdout);
+        scanf("%u", &(options.processes));
     }
-    bsp_sync();
-
-    // DEBUG
-    // Check that every PID expects the right amount of edges.
-    debug_expected_amount_of_edges(edges_in_pid);
-
 
-
-    /* Step c)
-    **
-    ** Prepare to receive the edges.
-    */
-
-    // Set up the edge array
-    nid_int (*local_edges)[2] = malloc(2 * edges_in_pid * sizeof(nid_int));
-    bsp_push_reg(local_edges, 2 * edges_in_pid * sizeof(nid_int));
-    bsp_sync();
-
-    // Send the appropriate edges to the right processes
-    if (p == 0) {
-        send_edges(edges, amountOfEdges, amountOfNodes, local_edges);
-        free(edges);
+    if (batch && options.output_path != NULL) {
+        fprintf(stderr, "Cannot write the matchings of a batch to a file.\n");
+        return EXIT_FAILURE;
     }
-    bsp_sync();
-
-    // DEBUG
-    // Check that every PID received the right edges.
-    debug_expected_edges(local_edges, edges_in_pid);
-
-
-
-    /* Step d)
-    **
-    ** Set up the structure in the process. No communication is required here.
-    */
-
-    struct graph *g = load_structure(amountOfNodes, edges_in_pid, local_edges);
-
-    // DEBUG
-    // Check that the node have been initialised properly.
-    debug_graph_setup(g);
-
-    // Clean up memory and BSP registers
-    bsp_pop_reg(&edges_in_pid);
-    bsp_pop_reg(&amountOfNodes);
-    free(local_edges);
-
-    bsp_sync();
 
+    if (batch && sparse) {
+        fprintf(stderr, "Cannot match a batch with sparse vertex IDs.\n");
+        return EXIT_FAILURE;
+    }
 
+    if (weighted && (batch || sparse)) {
+        fprintf(stderr, "Cannot match a weighted graph in batch mode or with "
+                        "sparse vertex IDs.\n");
+        return EXIT_FAILURE;
+    }
 
+    if (weighted && options.shared) {
+        fprintf(stderr, "Cannot match a weighted graph in shared memory.\n");
+        return EXIT_FAILURE;
+    }
 
-    /***********************************
-    *            SUPERSTEP 1           *
-    ************************************
-    * Get rid of all nodes of degree 1 *
-    ************************************/
-    
-    struct todo_list *todo;
-    struct instruction *response;
-
-    while (true) {
-        todo = get_todo_list();
-
-        remove_singletons(todo, g);
-
-        response = send_instructions(todo);
-
-        // // DEBUG
-        // // Check which responses were received
-        // debug_instruction_response(response, todo->expected_responses);
-
-        // Continue to the next phase when communication has stopped.
-        if (todo->expected_responses == 0) {
-            unallocate_todo_list(todo);
-            free(response);
+    if (weighted && options.quality_target > 0) {
+        fprintf(stderr, "Cannot aim for a fraction of the maximum weight.\n");
+        return EXIT_FAILURE;
+    }
 
-            break;
-        }
+    struct matcher *mt = create_matcher(options);
+    if (mt == NULL) {
+        return EXIT_FAILURE;
+    }
 
-        // Interpret the instructions
-        //printf("Interpreting instructions!\n");
-        for (nid_int i=0; i<todo->expected_responses; i++) {
-            //show_instruction(response[i]);
-            interpret_instruction(todo, g, &(response[i]));
-        }
+    if (batch) {
+        nid_int graphs = match_batch(mt);
 
-        // // DEBUG
-        // // Check what the graph looks like now.
-        // bsp_sync();
-        // debug_graph_setup(g);
+        printf("Matched " NID_FORMAT " graphs with " NID_FORMAT " edges in total "
+               "in %.6f seconds.\n",
+               graphs, mt->matches, matcher_seconds(mt));
+        printf("Peak memory of %ld KiB.\n", peak_memory());
 
-        // Clean up memory
-        unallocate_todo_list(todo);
-        free(response);
+        free(options.cores);
+        unallocate_matcher(mt);
 
-        // // Debug break
-        // break;
+        return EXIT_SUCCESS;
     }
 
-    debug_graph_setup(g);
-
-    // // DEBUG
-    // // Check the graph's state after superstep 1
-    // unallocate_graph(g);
-
-
+    // Read the graph
+    nid_int amountOfNodes;  // Amount of vertices in the graph
+    nid_int amountOfEdges;  // Amount of edges in the graph
 
+    prompt_graph_size(&amountOfNodes, &amountOfEdges);
 
-    /***********************************
-    *            SUPERSTEP 2           *
-    ************************************
-    * Create large snakes that travel  *
-    * through the graph as far as      *
-    * possible.                        *
-    ************************************/
+    nid_int (*edges)[2]        = NULL;
+    xid_int (*sparse_edges)[2] = NULL;
+    double   *weights          = NULL;
+    nid_int matches;
 
+    // Both backends print the same line, so that they can be compared.
+    if (sparse) {
+        sparse_edges = malloc((amountOfEdges + 1) * sizeof(xid_int[2]));
+        prompt_sparse_edges(sparse_edges, amountOfEdges);
 
+        matches = match_sparse_edges(mt, sparse_edges, amountOfEdges);
+    } else if (weighted) {
+        edges   = malloc((amountOfEdges + 1) * 2 * sizeof(nid_int));
+        weights = malloc((amountOfEdges + 1) * sizeof(double));
+        prompt_weighted_edges(edges, weights, amountOfEdges);
 
-    bsp_end();
-}
+        matches = match_weighted_edges(mt, amountOfNodes, edges, weights,
+                                       amountOfEdges, NULL);
+    } else {
+        edges = malloc((amountOfEdges + 1) * 2 * sizeof(nid_int));
+        prompt_edges(edges, amountOfEdges);
 
-/**
-* Setup function
-*/
-int main(int argc, char** argv) {
-    unsigned int j = 0;
-    
-    // Set up the processes
-    printf("How many processes would you like to use? There are %u cores available.\n", bsp_nprocs());
-    fflush(stdout);
-    scanf("%u", &AMOUNT_OF_CORES);
+        matches = match_edges(mt, amountOfNodes, edges, amountOfEdges, NULL);
+    }
 
-    if (AMOUNT_OF_CORES == 0 || AMOUNT_OF_CORES > bsp_nprocs()) {
-        fprintf(stderr, "Cannot start %u processes.\n", AMOUNT_OF_CORES);
-        return EXIT_FAILURE;
+    printf("Found a matching of " NID_FORMAT " edges in %.6f seconds.\n", 
+           matches, matcher_seconds(mt));
+    if (weighted) {
+        printf("The matching has a total weight of %.6f.\n", 
+               matcher_weight(mt));
     }
+    printf("Peak memory of %ld KiB.\n", peak_memory());
 
-    // Start the process
-    bsp_init(&spmd, argc, argv);
-    spmd();
+    free(edges);
+    free(sparse_edges);
+    free(weights);
+    free(options.cores);
+    unallocate_matcher(mt);
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -3,42 +3,457 @@ typedef unsigned int uint;
 // This value should be at least as large as:
 // - the number of PIDs.
 
+// Width in bits of vertex and edge identifiers: 32 (default) or 64. Build
+// with -DNID_BITS=64 for graphs with more than about 2 billion vertices or
+// edges. Smaller graphs keep the compact 32-bit layout.
+#ifndef NID_BITS
+#define NID_BITS 32
+#endif
+
+#if NID_BITS == 64
+typedef unsigned long long nid_int;
+typedef unsigned __int128 nid_wide;
+#define NID_FORMAT "%llu"
+#define NID_DIGITS 20
+#else
 typedef unsigned int nid_int;
+typedef unsigned long long nid_wide;
+#define NID_FORMAT "%u"
+#define NID_DIGITS 10
+#endif
 // This value should be at least as large as:
 // - the number of PIDs;
 // - the number of nodes    in the input graph;
-// - the number of vertices in the input graph.
+// - the number of vertices in the input graph;
+// - twice the number of edges in the input graph.
 //
-// NOTE: Make sure that you also update the scanf function that looks for
-// these values and casts them into variables.
+// Every printf and scanf of a nid_int uses NID_FORMAT, and NID_DIGITS is the
+// length of the largest nid_int in decimal. A nid_wide can hold the product
+// of a nid_int and the number of processes.
+
+// Original vertex identifiers of inputs with sparse IDs, which can be any
+// 64-bit number. The matcher remaps them to dense nid_int values at ingest,
+// and maps the matches back to them on output.
+typedef unsigned long long xid_int;
+#define XID_FORMAT "%llu"
+#define XID_DIGITS 20
+
+// Default BSP machine parameters, used to predict the cost of a run. The
+// probe program measures the real values of a machine, which the matcher
+// loads with its -m option.
+// - BSP_G      Time in seconds to communicate one byte, for large h-relations.
+// - BSP_L      Time in seconds of a synchronisation without communication.
+#define BSP_G 1e-9
+#define BSP_L 1e-5
+
+// Settings of the probe program.
+// - PROBE_MAX_H        Largest h-relation in words that is measured.
+// - PROBE_ITERATIONS   Amount of supersteps that are timed per h-relation.
+#define PROBE_MAX_H      256
+#define PROBE_ITERATIONS 100
+
+// Amount of supersteps for which the matcher compares the predicted cost with
+// the measured cost. These are the supersteps that took longest.
+#define STATS_WORST_SUPERSTEPS 5
+
+// How much the processes trace while they run. Set this value at compile time,
+// for example with -DTRACE_LEVEL=2. Release builds use 0, which removes all
+// tracing from the program.
+// - 0  No tracing.
+// - 1  (TRACE_ROUNDS)  A message per process in every round.
+// - 2  (TRACE_CHANGES) A message for every change to the graph.
+// - 3  (TRACE_GRAPH)   Dumps of the full graph structure.
+// Every process keeps its latest TRACE_RING_SIZE messages in memory and
+// writes them to the file TRACE_PATH at the end of the run.
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 0
+#endif
+#define TRACE_RING_SIZE   65536
+#define TRACE_LINE_LENGTH 160
+#define TRACE_PATH        "trace-%u.log"
+
+// OpenMP directive of the local phases. Build with -fopenmp to run them on
+// several threads per process. Without it, the directives disappear and
+// every process runs on a single thread.
+#ifdef _OPENMP
+#define OMP(directive) _Pragma(#directive)
+#else
+#define OMP(directive)
+#endif
+
+// Phases of the BSP backend that show up in the timeline. See `TIMELINE_NAMES`
+// in trace.c for their names in the trace viewer.
+#define PHASE_LOAD_STRUCTURE          0
+#define PHASE_SMALL_COMPONENTS        1
+#define PHASE_REMOVE_SINGLETONS       2
+#define PHASE_SEND_INSTRUCTIONS       3
+#define PHASE_INTERPRET_INSTRUCTIONS  4
+#define PHASE_CLEAN_EDGES             5
+#define PHASE_MATCH_DOMINANT_EDGES    6
+
+// Strategies of `divide()` to distribute the vertices across processes.
+#define DIVIDE_BLOCK  0
+#define DIVIDE_CYCLIC 1
+
+// Value in a mate array for vertices that have not been matched (yet).
+#define NO_MATE ((nid_int) -1)
 
 // The defined instructions.
 // The instructions are evaluated in an ascending order.
-#define MAX_INSTR_VAL 6
-//------------------- :
-#define CONCATENATE   5
-#define REVERSE       4
-#define INHERIT       3
-#define MOVE          2
-#define DELETE        1
-#define KEEP_ALIVE    0
+#define MAX_INSTR_VAL     14
+//----------------------- :
+#define PROPOSE           13
+#define VALIDATE_LEAF     12
+#define VALIDATE_FREE     11
+#define VALIDATE_MATCH    10
+#define COMPONENT_EDGE     9
+#define COMPONENT_VERDICT  8
+#define COMPONENT_SIZE     7
+#define COMPONENT_LABEL    6
+#define CONCATENATE        5
+#define REVERSE            4
+#define INHERIT            3
+#define MOVE               2
+#define DELETE             1
+#define KEEP_ALIVE         0
 
+// Connected components with at most this many vertices are gathered on a
+// single process and matched there without any further communication.
+// Larger components go through the distributed supersteps.
+// Set this value to 0 to send every component through the supersteps.
+#define SMALL_COMPONENT_SIZE 4096
 
+// In batch mode, graphs with at most this many edges are matched on a single
+// process, next to other small graphs on the other processes. Larger graphs
+// go through the distributed supersteps, one at a time.
+#define BATCH_SMALL_EDGES 65536
+
+// Removed vertices stay behind in the vertex array of a process, so that
+// indices stay valid. The array is compacted once the removed entries pass
+// this fraction of it.
+#define DEAD_VERTEX_FRACTION 0.5
+
+
+struct batch_round;
+struct csr_graph;
+struct deque;
+struct deque_array;
 struct graph;
+struct id_dictionary;
+struct id_table;
+struct input_graph;
 struct instruction;
+struct shared_matching;
+struct stats;
+struct superstep_stats;
+struct timeline;
+struct trace_ring;
+struct matcher;
+struct matcher_options;
 struct matching;
 struct node;
 struct todo_list;
 
 
+/**
+ * Graph that the caller of the matcher hands over. The matcher reads it
+ * without copying it. Either `edges`, `sparse_edges` or `csr` is set.
+ *
+ * Attributes:
+ * - `nodes`        Amount of vertices in the graph. Unused for sparse IDs.
+ * - `edges`        Array of edges, with vertices counted from 0.
+ * - `sparse_edges` Array of edges between arbitrary original vertex IDs.
+ * - `edges_length` Array length of `edges` or `sparse_edges`.
+ * - `weights`      Weight of every edge of `edges`, or NULL for an
+ *                  unweighted graph.
+ * - `csr`          Graph structure that lists every edge in both directions.
+ */
+struct input_graph {
+    nid_int nodes;
+
+    nid_int (*edges)[2];
+    xid_int (*sparse_edges)[2];
+    nid_int edges_length;
+
+    double *weights;
+
+    const struct csr_graph *csr;
+};
+
+/**
+ * Settings of a matcher. Start from `default_matcher_options()`.
+ *
+ * Attributes:
+ * - `processes`        Amount of BSP processes, or of threads in shared
+ *                      memory.
+ * - `threads`          Amount of threads within each process.
+ * - `shared`           Whether to match with threads in shared memory instead
+ *                      of BSP processes.
+ * - `divide`           Distribution of vertices across processes, one of the
+ *                      DIVIDE_* values.
+ * - `cores`            Cores to pin processes and threads to, in order, or
+ *                      NULL to leave them unpinned.
+ * - `cores_length`     Array length of `cores`.
+ * - `small_components` Whether to match small components without
+ *                      communication first.
+ * - `validate`         Whether to validate the matching after the run.
+ * - `optimistic`       Whether a process drops its edges to a node of
+ *                      another process as soon as it sends that node a
+ *                      singleton, instead of a round later.
+ * - `quality_target`   Stop the supersteps once the matching has at least
+ *                      this fraction of the size of a maximum matching, or
+ *                      0 to run until the matching is maximal. Weighted
+ *                      graphs can't use it.
+ * - `time_budget`      Stop the supersteps after this many seconds, or 0 to
+ *                      run until the matching is maximal.
+ * - `stats_path`       CSV file for the measurements of every superstep, or
+ *                      NULL to skip them.
+ * - `timeline_path`    Chrome trace-event file for the phases of every
+ *                      process, or NULL to skip it.
+ * - `output_path`      File for the matching, or NULL to skip it.
+ * - `g`                BSP parameter g to predict the cost with.
+ * - `l`                BSP parameter l to predict the cost with.
+ */
+struct matcher_options {
+    uint processes;
+    uint threads;
+    bool shared;
+    short int divide;
+
+    int *cores;
+    uint cores_length;
+
+    bool small_components;
+    bool validate;
+    bool optimistic;
+
+    double quality_target;
+    double time_budget;
+
+    const char *stats_path;
+    const char *timeline_path;
+    const char *output_path;
+
+    double g;
+    double l;
+};
+
+/**
+ * Matcher that can be run on several graphs, one after the other.
+ *
+ * Attributes:
+ * - `options`  Settings of the matcher.
+ * - `input`    Graph of the current run.
+ * - `mate`     Array that receives the partner of every vertex, or NULL.
+ * - `graphs`   Amount of graphs in the last run.
+ * - `matches`  Size of the matching of the last run.
+ * - `weight`   Total weight of the matching of the last run, for a weighted
+ *              graph.
+ * - `seconds`  Duration of the last run, without reading the input.
+ */
+struct matcher {
+    struct matcher_options options;
+
+    const struct input_graph *input;
+    nid_int *mate;
+
+    nid_int graphs;
+    nid_int matches;
+    double  weight;
+    double  seconds;
+};
+
+/**
+ * Work of a process in one round of batch mode.
+ *
+ * Attributes:
+ * - `graph`        Number of the small graph that the process matches,
+ *                  counted from 1 in the order of the input.
+ * - `edges_length` Amount of edges in the small graph.
+ * - `solve`        Whether the process has a small graph to match.
+ * - `large`        Whether all processes match a large graph afterwards.
+ * - `done`         Whether this is the last round.
+ */
+struct batch_round {
+    nid_int graph;
+    nid_int edges_length;
+
+    bool solve;
+    bool large;
+    bool done;
+};
+
+/**
+ * Graph structure in compressed sparse row format, shared by all threads.
+ *
+ * Attributes:
+ * - `nodes`        Amount of vertices in the graph.
+ * - `offsets`      For each vertex, where its neighbours start in `targets`.
+ *                  The array has length `nodes + 1`.
+ * - `targets`      Neighbours of all vertices, one after the other.
+ */
+struct csr_graph {
+    nid_int  nodes;
+
+    nid_int *offsets;
+    nid_int *targets;
+};
+
+/**
+ * Work-stealing deque of vertices.
+ *
+ * The owning thread pushes and takes vertices at the bottom, other threads
+ * steal them from the top. No locks are used.
+ *
+ * Attributes:
+ * - `top`      Index of the oldest vertex in the deque.
+ * - `bottom`   Index right after the newest vertex in the deque.
+ * - `array`    Circular array that stores the vertices.
+ */
+struct deque {
+    _Atomic long top;
+    _Atomic long bottom;
+
+    struct deque_array *_Atomic array;
+};
+
+/**
+ * Circular array of a work-stealing deque.
+ *
+ * Attributes:
+ * - `size`     Amount of vertices that fit in the array.
+ * - `previous` Smaller array that this array replaced. Other threads may
+ *              still be reading it, so it is only freed with the deque.
+ * - `buffer`   The vertices.
+ */
+struct deque_array {
+    long size;
+
+    struct deque_array *previous;
+
+    _Atomic nid_int buffer[];
+};
+
+/**
+ * State of a matching that all threads work on at the same time.
+ *
+ * Attributes:
+ * - `csr`          Shared graph structure.
+ * - `mate`         The mate of every vertex, or `NO_MATE`. A vertex is only
+ *                  matched once its mate points back at it.
+ * - `degree`       Estimate of the amount of unmatched neighbours of each
+ *                  vertex. It is only used to choose which vertex goes first.
+ * - `singles`      Deques of vertices of degree 1, one for each thread.
+ * - `doubles`      Deques of vertices of degree 2, one for each thread.
+ * - `match_cursor` Start of the next chunk of `SHARED_CHUNK_SIZE` vertices
+ *                  that a thread takes to match when the deques are empty.
+ *                  The deques are seeded from fixed blocks of vertices
+ *                  instead, before any thread starts matching.
+ */
+struct shared_matching {
+    const struct csr_graph *csr;
+
+    _Atomic nid_int *mate;
+    _Atomic long    *degree;
+
+    struct deque *singles;
+    struct deque *doubles;
+
+    _Atomic nid_int match_cursor;
+};
+
+/**
+ * Hash table that gives every distinct original vertex ID a dense index, in
+ * the order in which the IDs arrive. It never grows, so it needs to know how
+ * many IDs to expect.
+ *
+ * Attributes:
+ * - `keys`     Original ID in every slot.
+ * - `values`   Dense index in every slot, or NO_MATE if the slot is empty.
+ * - `capacity` Amount of slots, a power of two.
+ * - `ids`      Original ID of every dense index.
+ * - `length`   Amount of distinct IDs in the table.
+ */
+struct id_table {
+    xid_int *keys;
+    nid_int *values;
+    nid_int capacity;
+
+    xid_int *ids;
+    nid_int length;
+};
+
+/**
+ * The part of the dictionary between dense and original vertex IDs that this
+ * process owns. Every process owns a consecutive range of dense IDs.
+ *
+ * Attributes:
+ * - `ids`      Original ID of every dense ID that this process owns.
+ * - `offset`   First dense ID that this process owns.
+ * - `length`   Amount of dense IDs that this process owns.
+ * - `offsets`  First dense ID of every process, followed by the total amount
+ *              of vertices.
+ */
+struct id_dictionary {
+    xid_int *ids;
+    nid_int offset;
+    nid_int length;
+
+    nid_int *offsets;
+};
+
+/**
+ * The part of the graph that a process manages.
+ *
+ * Attributes:
+ * - `vertex`           Nodes of this process, sorted by identifier. Removed
+ *                      nodes leave NULL behind until `compact_graph()`.
+ * - `values`           Identifier of every entry of `vertex`, also of the
+ *                      removed ones, to look nodes up by binary search.
+ * - `m`                Matches that this process found.
+ * - `guessed`          Amount of matches in `m` that no node of degree 1
+ *                      forced, so that a maximum matching may not have them.
+ * - `max_size`         Array capacity of `vertex` and `values`.
+ * - `local_degree`     Array length of `vertex` and `values`.
+ * - `alive`            Amount of entries of `vertex` that were not removed.
+ * - `frontier`         Identifiers of the nodes whose degree changed since
+ *                      `remove_singletons()` last looked at them.
+ * - `frontier_length`  Array length of `frontier`.
+ * - `moved`            Singletons that this process sent to a neighbour in
+ *                      another process in the last `remove_singletons()`,
+ *                      with that neighbour, sorted.
+ * - `moved_length`     Array length of `moved`.
+ * - `ghosts`           Edges to nodes of other processes, as pairs of that
+ *                      node and the node of this process, sorted. NULL until
+ *                      `index_ghosts()`.
+ * - `ghosts_length`    Array length of `ghosts`.
+ * - `global_degree`    Amount of vertices in the global graph.
+ * - `pid`              PID of this process.
+ * - `processes`        Amount of processes.
+ */
 struct graph {
     struct node **vertex;
+    nid_int      *values;
 
     struct matching *m;
+    nid_int          guessed;
 
     nid_int max_size;
     nid_int local_degree;
+    nid_int alive;
     nid_int global_degree;
+
+    nid_int *frontier;
+    nid_int  frontier_length;
+
+    nid_int (*moved)[2];
+    nid_int   moved_length;
+
+    nid_int (*ghosts)[2];
+    nid_int   ghosts_length;
+
+    uint pid;
+    uint processes;
 };
 
 /**
@@ -64,13 +479,117 @@ struct matching {
 
     nid_int length;
     nid_int max_length;
+
+    double weight;
 };
 
+/**
+ * Vertex of the graph of a process.
+ *
+ * Attributes:
+ * - `value`        Unique node identifier.
+ * - `component`    Smallest node identifier in its connected component.
+ * - `connections`  Neighbours, of which some may have been removed.
+ * - `weights`      Weight of every connection, or NULL for an unweighted
+ *                  graph.
+ * - `order`        Positions in `connections`, sorted by neighbour.
+ * - `removed`      Bitmap of the removed connections, or NULL if there are
+ *                  none. See `compact_edges()`.
+ * - `length`       Array length of parameters `connections`, `weights` and
+ *                  `order`.
+ * - `degree`       Amount of neighbours that were not removed.
+ * - `active`       Whether the node is in the frontier of its graph.
+ * - `claimed`      Whether a singleton took the node as its match.
+ */
 struct node {
     nid_int  value;
+    nid_int  component;
 
-    nid_int *connections;
-    nid_int  degree;
+    nid_int            *connections;
+    double             *weights;
+    nid_int            *order;
+    unsigned long long *removed;
+    nid_int             length;
+    nid_int             degree;
+
+    bool active;
+    bool claimed;
+};
+
+/**
+ * Measurements of a single process during a single superstep.
+ *
+ * Attributes:
+ * - `compute`          Seconds between the end of the previous superstep and
+ *                      the start of the synchronisation.
+ * - `sync`             Seconds spent waiting in `bsp_sync`.
+ * - `vertices_removed` Amount of vertices that were removed from the graph.
+ * - `edges_removed`    Amount of edges that were removed with those vertices.
+ * - `messages_to`      For each process, the amount of `bsp_put` calls.
+ * - `bytes_to`         For each process, the amount of bytes that were put.
+ */
+struct superstep_stats {
+    double compute;
+    double sync;
+
+    unsigned long long vertices_removed;
+    unsigned long long edges_removed;
+
+    unsigned long long *messages_to;
+    unsigned long long *bytes_to;
+};
+
+/**
+ * Measurements of a single process across all of its supersteps.
+ *
+ * Attributes:
+ * - `supersteps`       Array of all finished supersteps, and the current one.
+ * - `length`           Amount of finished supersteps.
+ * - `max_length`       Array length of parameter `supersteps`.
+ * - `last_sync`        Time at which the previous superstep ended.
+ */
+struct stats {
+    struct superstep_stats *supersteps;
+
+    nid_int length;
+    nid_int max_length;
+
+    double last_sync;
+};
+
+/**
+ * Timestamped phases of a process, for the trace viewer.
+ *
+ * Attributes:
+ * - `events`       Array of phases, with TIMELINE_FIELDS values each: the
+ *                  phase, the round, the start time and the end time.
+ * - `length`       Amount of phases in the array.
+ * - `max_length`   Amount of phases that fit in the array.
+ */
+struct timeline {
+    double *events;
+
+    nid_int length;
+    nid_int max_length;
+};
+
+/**
+ * Ring buffer of the latest trace messages of a process.
+ *
+ * Attributes:
+ * - `times`    Time at which each message was written.
+ * - `lines`    The messages.
+ * - `next`     Index that the next message is written to.
+ * - `length`   Amount of messages in the buffer.
+ * - `dropped`  Amount of messages that were overwritten by newer ones.
+ */
+struct trace_ring {
+    double *times;
+    char  (*lines)[TRACE_LINE_LENGTH];
+
+    nid_int next;
+    nid_int length;
+    nid_int dropped;
 };
 
 /**
@@ -14,25 +14,52 @@ struct matching *create_matching(nid_int max_size) {
 
     m->length     = 0;
     m->max_length = max_size;
+    m->weight     = 0;
 
     return m;
 }
 
 /**
- * Add a new match to the the matching structure.
+ * Add a new match to the the matching structure. The structure grows when it
+ * is full.
  *
  * Parameters:
+ * - `m`        The matching structure.
  * - `a`        Unique node identifier.
  * - `b`        Unique node identifier.
  */
 void insert_match(struct matching *m, nid_int a, nid_int b) {
     nid_int size = m->length;
 
+    // Processes may add matches of vertices that they don't own, so the
+    // initial estimate can be too small.
+    if (size == m->max_length) {
+        m->max_length = 2 * m->max_length + 1;
+        m->matches    = realloc(m->matches, 
+                                2 * m->max_length * sizeof(nid_int));
+    }
+
     m->matches[size][0] = a;
     m->matches[size][1] = b;
     m->length = size + 1;
 }
 
+/**
+ * Make sure that the matching structure has room for more matches.
+ *
+ * Parameters:
+ * - `m`        The matching structure.
+ * - `extra`    The amount of matches that may still be inserted.
+ */
+void reserve_matching(struct matching *m, nid_int extra) {
+    if (m->length + extra <= m->max_length) {
+        return;
+    }
+
+    m->max_length = m->length + extra;
+    m->matches    = realloc(m->matches, 2 * m->max_length * sizeof(nid_int));
+}
+
 /**
  * Erase the matching object from memory.
  *
@@ -10,14 +10,25 @@
 struct matching *create_matching(nid_int max_size);
 
 /**
- * Add a new match to the the matching structure.
+ * Add a new match to the the matching structure. The structure grows when it
+ * is full.
  *
  * Parameters:
+ * - `m`        The matching structure.
  * - `a`        Unique node identifier.
  * - `b`        Unique node identifier.
  */
 void insert_match(struct matching *m, nid_int a, nid_int b);
 
+/**
+ * Make sure that the matching structure has room for more matches.
+ *
+ * Parameters:
+ * - `m`        The matching structure.
+ * - `extra`    The amount of matches that may still be inserted.
+ */
+void reserve_matching(struct matching *m, nid_int extra);
+
 /**
  * Erase the matching object from memory.
  *
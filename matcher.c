@@ -0,0 +1,1136 @@
+#define _GNU_SOURCE
+
+#include <bsp.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "main.h"
+
+#include "components.c"
+#include "debug.c"
+#include "divide.c"
+#include "graph.c"
+#include "ingest.c"
+#include "instructions.c"
+#include "match.c"
+#include "output.c"
+#include "placement.c"
+#include "sequential.c"
+#include "shared.c"
+#include "stats.c"
+#include "steps.c"
+#include "trace.c"
+#include "utilities.c"
+#include "validate.c"
+
+#include "matcher.h"
+
+// Matcher whose graph the processes are matching. The processes share it.
+static struct matcher *RUNNING = NULL;
+
+// PRIVATE FUNCTIONS
+void batch_spmd(void);
+void end_session(void);
+void match_distributed(const struct input_graph *input, bool sparse,
+                       bool weighted);
+void read_batch_round(struct batch_round *rounds, struct input_graph *small,
+                      struct input_graph *large, nid_int *graphs);
+nid_int run_matcher(struct matcher *mt, const struct input_graph *input,
+                    nid_int *mate);
+void shared(void);
+nid_int solve_batch_round(struct batch_round *round, struct input_graph *small);
+void spmd(void);
+void start_session(void);
+bool stop_early(struct graph *g, nid_int round, double start_time,
+                bool weighted);
+
+/**
+ * Get the default settings of a matcher: every core as a BSP process with a
+ * single thread, block distribution, and no reports.
+ *
+ * Returns:     Settings of a matcher.
+ */
+struct matcher_options default_matcher_options(void) {
+    struct matcher_options options;
+
+    options.processes        = bsp_nprocs();
+    options.threads          = 1;
+    options.shared           = false;
+    options.divide           = DIVIDE_BLOCK;
+    options.cores            = NULL;
+    options.cores_length     = 0;
+    options.small_components = true;
+    options.validate         = false;
+    options.optimistic       = false;
+    options.quality_target   = 0;
+    options.time_budget      = 0;
+    options.stats_path       = NULL;
+    options.timeline_path    = NULL;
+    options.output_path      = NULL;
+    options.g                = BSP_G;
+    options.l                = BSP_L;
+
+    return options;
+}
+
+/**
+ * Create a matcher that can match several graphs, one after the other. Only
+ * one matcher may run at a time.
+ *
+ * Parameters:
+ * - `options`  Settings of the matcher.
+ *
+ * Returns:     Matcher, or NULL if the settings are invalid.
+ */
+struct matcher *create_matcher(struct matcher_options options) {
+    if (options.processes == 0 || options.processes > bsp_nprocs()) {
+        fprintf(stderr, "Cannot start %u processes.\n", options.processes);
+        return NULL;
+    }
+
+    if (options.threads == 0) {
+        fprintf(stderr, "Cannot start %u threads per process.\n",
+                options.threads);
+        return NULL;
+    }
+
+    if (options.cores != NULL &&
+        options.cores_length < options.processes * options.threads) {
+        fprintf(stderr, "Cannot pin %u threads to %u cores.\n",
+                options.processes * options.threads, options.cores_length);
+        return NULL;
+    }
+
+    if (options.quality_target < 0 || options.quality_target > 1 ||
+        options.time_budget < 0) {
+        fprintf(stderr, "Cannot aim for %g of the maximum size within %g "
+                "seconds.\n", options.quality_target, options.time_budget);
+        return NULL;
+    }
+
+    if (options.shared && 
+        (options.quality_target > 0 || options.time_budget > 0)) {
+        fprintf(stderr, "Cannot stop the shared-memory backend early.\n");
+        return NULL;
+    }
+
+    struct matcher *mt = malloc(sizeof(struct matcher));
+
+    mt->options = options;
+    mt->input   = NULL;
+    mt->mate    = NULL;
+    mt->graphs  = 0;
+    mt->matches = 0;
+    mt->weight  = 0;
+    mt->seconds = 0;
+
+    return mt;
+}
+
+/**
+ * Find a maximal matching in a graph that is given as an array of edges. The
+ * matcher reads the array without copying it.
+ *
+ * Parameters:
+ * - `mt`           Matcher.
+ * - `nodes`        Amount of vertices in the graph.
+ * - `edges`        Array of edges, with vertices counted from 0.
+ * - `edges_length` Array length of `edges`.
+ * - `mate`         Array of length `nodes` that will store the partner of
+ *                  every vertex, or NO_MATE. May be NULL.
+ *
+ * Returns:         Amount of edges in the matching.
+ */
+nid_int match_edges(struct matcher *mt, nid_int nodes, nid_int (*edges)[2],
+                    nid_int edges_length, nid_int *mate) {
+    struct input_graph input;
+
+    input.nodes        = nodes;
+    input.edges        = edges;
+    input.sparse_edges = NULL;
+    input.edges_length = edges_length;
+    input.weights      = NULL;
+    input.csr          = NULL;
+
+    return run_matcher(mt, &input, mate);
+}
+
+/**
+ * Find a maximal matching in a graph that is given as a graph structure. The
+ * structure must list every edge in both directions. The matcher reads it
+ * without copying it.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ * - `csr`      Graph structure.
+ * - `mate`     Array of length `csr->nodes` that will store the partner of
+ *              every vertex, or NO_MATE. May be NULL.
+ *
+ * Returns:     Amount of edges in the matching.
+ */
+nid_int match_csr(struct matcher *mt, const struct csr_graph *csr,
+                  nid_int *mate) {
+    struct input_graph input;
+
+    input.nodes        = csr->nodes;
+    input.edges        = NULL;
+    input.sparse_edges = NULL;
+    input.edges_length = 0;
+    input.weights      = NULL;
+    input.csr          = csr;
+
+    return run_matcher(mt, &input, mate);
+}
+
+/**
+ * Find a maximal matching in a graph whose vertices have arbitrary IDs, for
+ * example 64-bit hashes. The matcher gives the vertices dense IDs first, and
+ * writes the matching with the original IDs to the output file, if any. The
+ * matcher reads the array without copying it.
+ *
+ * Parameters:
+ * - `mt`           Matcher.
+ * - `edges`        Array of edges between original vertex IDs.
+ * - `edges_length` Array length of `edges`.
+ *
+ * Returns:         Amount of edges in the matching.
+ */
+nid_int match_sparse_edges(struct matcher *mt, xid_int (*edges)[2],
+                           nid_int edges_length) {
+    struct input_graph input;
+
+    input.nodes        = 0;
+    input.edges        = NULL;
+    input.sparse_edges = edges;
+    input.edges_length = edges_length;
+    input.weights      = NULL;
+    input.csr          = NULL;
+
+    return run_matcher(mt, &input, NULL);
+}
+
+/**
+ * Find a matching of high weight in a weighted graph that is given as an
+ * array of edges. The matching has at least half the weight of a maximum
+ * weight matching, and is maximal. The matcher reads the arrays without
+ * copying them.
+ *
+ * Only the BSP backend matches weighted graphs. A quality target can't be
+ * set, as the bound of the anytime mode counts edges and not weight. A time
+ * budget can.
+ *
+ * Parameters:
+ * - `mt`           Matcher.
+ * - `nodes`        Amount of vertices in the graph.
+ * - `edges`        Array of edges, with vertices counted from 0.
+ * - `weights`      Weight of every edge.
+ * - `edges_length` Array length of `edges` and `weights`.
+ * - `mate`         Array of length `nodes` that will store the partner of
+ *                  every vertex, or NO_MATE. May be NULL.
+ *
+ * Returns:         Amount of edges in the matching. See `matcher_weight()`
+ *                  for its weight.
+ */
+nid_int match_weighted_edges(struct matcher *mt, nid_int nodes,
+                             nid_int (*edges)[2], double *weights,
+                             nid_int edges_length, nid_int *mate) {
+    if (mt->options.shared) {
+        fprintf(stderr, "Cannot match a weighted graph in shared memory.\n");
+        return 0;
+    }
+
+    if (mt->options.quality_target > 0) {
+        fprintf(stderr, "Cannot aim for a fraction of the maximum weight.\n");
+        return 0;
+    }
+
+    struct input_graph input;
+
+    input.nodes        = nodes;
+    input.edges        = edges;
+    input.sparse_edges = NULL;
+    input.edges_length = edges_length;
+    input.weights      = weights;
+    input.csr          = NULL;
+
+    return run_matcher(mt, &input, mate);
+}
+
+/**
+ * Match every graph on stdin in a single BSP session, and print the size of
+ * every matching as soon as it is found. The graphs follow each other in the
+ * input format, without asking for them.
+ *
+ * Small graphs are matched on a single process each, so that the processes
+ * match as many graphs at the same time. Large graphs go through the
+ * distributed supersteps, one at a time.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ *
+ * Returns:     Amount of graphs.
+ */
+nid_int match_batch(struct matcher *mt) {
+    mt->input   = NULL;
+    mt->mate    = NULL;
+    mt->graphs  = 0;
+    mt->matches = 0;
+    mt->weight  = 0;
+    mt->seconds = 0;
+
+    set_divide_strategy(mt->options.divide);
+    set_core_list(mt->options.cores, mt->options.cores_length);
+
+    // Threads in shared memory start quickly, so they take one graph after
+    // the other.
+    if (mt->options.shared) {
+        double start_time = wall_time();
+        nid_int matches   = 0;
+        nid_int graphs    = 0;
+
+        struct input_graph input;
+        input.sparse_edges = NULL;
+        input.weights      = NULL;
+        input.csr          = NULL;
+
+        while (scan_graph_size(&(input.nodes), &(input.edges_length))) {
+            input.edges = malloc((input.edges_length + 1) * 2 * sizeof(nid_int));
+            prompt_edges(input.edges, input.edges_length);
+            graphs++;
+
+            run_matcher(mt, &input, NULL);
+            matches = matches + mt->matches;
+
+            printf("Graph " NID_FORMAT ": matching of " NID_FORMAT " edges in "
+                   "%.6f seconds.\n", graphs, mt->matches, mt->seconds);
+            fflush(stdout);
+
+            free(input.edges);
+        }
+
+        mt->graphs  = graphs;
+        mt->matches = matches;
+        mt->seconds = wall_time() - start_time;
+
+        return graphs;
+    }
+
+    RUNNING = mt;
+    bsp_init(&batch_spmd, 0, NULL);
+    batch_spmd();
+    RUNNING = NULL;
+
+    return mt->graphs;
+}
+
+/**
+ * Get the duration of the last run of a matcher, without handing over the
+ * graph.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ *
+ * Returns:     Duration in seconds.
+ */
+double matcher_seconds(struct matcher *mt) {
+    return mt->seconds;
+}
+
+/**
+ * Get the total weight of the matching of the last run of a matcher on a
+ * weighted graph.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ *
+ * Returns:     Total weight of the matching.
+ */
+double matcher_weight(struct matcher *mt) {
+    return mt->weight;
+}
+
+/**
+ * Unallocate a matcher.
+ *
+ * Parameters:
+ * - `mt`       The matcher that is to be freed from memory.
+ */
+void unallocate_matcher(struct matcher *mt) {
+    free(mt);
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Match a graph with the backend that the matcher's settings ask for.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ * - `input`    Graph to match.
+ * - `mate`     Array that will store the partner of every vertex, or NULL.
+ *
+ * Returns:     Amount of edges in the matching.
+ */
+nid_int run_matcher(struct matcher *mt, const struct input_graph *input,
+                    nid_int *mate) {
+    mt->input   = input;
+    mt->mate    = mate;
+    mt->graphs  = 1;
+    mt->matches = 0;
+    mt->weight  = 0;
+    mt->seconds = 0;
+
+    set_divide_strategy(mt->options.divide);
+    set_core_list(mt->options.cores, mt->options.cores_length);
+
+    RUNNING = mt;
+
+    if (mt->options.shared) {
+        shared();
+    } else {
+        bsp_init(&spmd, 0, NULL);
+        spmd();
+    }
+
+    RUNNING     = NULL;
+    mt->input   = NULL;
+    mt->mate    = NULL;
+
+    return mt->matches;
+}
+
+/** PRIVATE
+ * Function that matches the graph on a single machine without BSP processes.
+ */
+void shared(void) {
+    struct matcher_options *options = &(RUNNING->options);
+    const struct input_graph *input = RUNNING->input;
+
+    set_thread_count(options->processes * options->threads);
+    pin_threads();
+
+    double start_time = wall_time();
+
+    // Sparse vertex IDs are made dense before anything else.
+    nid_int nodes       = input->nodes;
+    nid_int (*dense)[2] = NULL;
+    xid_int *ids        = NULL;
+
+    if (input->sparse_edges != NULL) {
+        dense = malloc((input->edges_length + 1) * sizeof(nid_int[2]));
+        nodes = remap_ids(input->sparse_edges, input->edges_length, dense,
+                          &ids);
+    }
+
+    // A graph structure is matched as it is. An edge array needs one.
+    struct csr_graph *own = NULL;
+
+    if (dense != NULL) {
+        own = create_csr_graph(nodes, dense, input->edges_length);
+    } else if (input->csr == NULL) {
+        own = create_csr_graph(input->nodes, input->edges,
+                               input->edges_length);
+    }
+    const struct csr_graph *csr = (own != NULL) ? own : input->csr;
+
+    nid_int *mate = RUNNING->mate;
+    if (mate == NULL) {
+        mate = malloc((nodes + 1) * sizeof(nid_int));
+    }
+
+    RUNNING->matches = match_shared(csr, mate);
+    RUNNING->seconds = wall_time() - start_time;
+
+    if (options->validate) {
+        validate_mates(csr, mate);
+    }
+
+    if (options->output_path != NULL) {
+        write_mates(mate, nodes, ids, options->output_path);
+    }
+
+    if (RUNNING->mate == NULL) {
+        free(mate);
+    }
+    if (own != NULL) {
+        unallocate_csr_graph(own);
+    }
+    free(dense);
+    free(ids);
+}
+
+/** PRIVATE
+* Function that runs synchronously on multiple cores.
+*/
+void spmd(void) {
+    bsp_begin(RUNNING->options.processes);
+    start_session();
+
+    match_distributed(RUNNING->input, RUNNING->input->sparse_edges != NULL,
+                      RUNNING->input->weights != NULL);
+
+    end_session();
+    bsp_end();
+}
+
+/** PRIVATE
+* Function that runs synchronously on multiple cores, and matches every graph
+* on stdin.
+*/
+void batch_spmd(void) {
+    bsp_begin(RUNNING->options.processes);
+    start_session();
+
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    double start_time = bsp_time();
+    nid_int graphs    = 0;  // Amount of graphs that the first process read
+    nid_int matches   = 0;  // Sum of the matchings found by this process
+
+    struct batch_round round;
+    bsp_push_reg(&round, sizeof(struct batch_round));
+    counted_sync();
+
+    struct batch_round *rounds = NULL;
+    struct input_graph *small  = NULL;
+    struct input_graph large;
+
+    if (p == 0) {
+        rounds = malloc(n * sizeof(struct batch_round));
+        small  = malloc(n * sizeof(struct input_graph));
+    }
+
+    do {
+        // Read as many small graphs as there are processes, or up to the
+        // next large graph, and tell each process which graph it gets.
+        if (p == 0) {
+            read_batch_round(rounds, small, &large, &graphs);
+
+            for (uint i=0; i<n; i++) {
+                counted_put(i, &(rounds[i]), &round, 0,
+                            sizeof(struct batch_round));
+            }
+        }
+        counted_sync();
+
+        matches = matches + solve_batch_round(&round, small);
+
+        if (round.large) {
+            match_distributed((p == 0) ? &large : NULL, false, false);
+
+            if (p == 0) {
+                printf("Graph " NID_FORMAT ": matching of " NID_FORMAT 
+                       " edges in %.6f seconds.\n", 
+                       graphs, RUNNING->matches, RUNNING->seconds);
+                fflush(stdout);
+
+                matches = matches + RUNNING->matches;
+                free(large.edges);
+            }
+        }
+    } while (!round.done);
+
+    // Small graphs were matched on every process.
+    matches = sum_across_processes(matches);
+
+    if (p == 0) {
+        RUNNING->graphs  = graphs;
+        RUNNING->matches = matches;
+        RUNNING->seconds = bsp_time() - start_time;
+
+        free(rounds);
+        free(small);
+    }
+
+    bsp_pop_reg(&round);
+    counted_sync();
+
+    end_session();
+    bsp_end();
+}
+
+/** PRIVATE
+ * Start the reports of a BSP session, right after the processes begin.
+ */
+void start_session(void) {
+    struct matcher_options *options = &(RUNNING->options);
+
+    set_thread_count(options->threads);
+    pin_process(options->threads);
+    start_stats();
+    start_trace();
+
+    if (options->timeline_path != NULL) {
+        start_timeline();
+    }
+
+    counted_sync();
+
+    if (options->cores != NULL) {
+        report_placement();
+    }
+}
+
+/** PRIVATE
+ * Find a maximal matching in a graph with the distributed supersteps. All
+ * processes call this function together.
+ *
+ * Parameters:
+ * - `input`    Graph to match. Only the first process reads it.
+ * - `sparse`   Whether the graph has sparse vertex IDs.
+ * - `weighted` Whether the graph has edge weights.
+ */
+void match_distributed(const struct input_graph *input, bool sparse,
+                       bool weighted) {
+    struct matcher_options *options = &(RUNNING->options);
+
+    /***********************************
+    *       INITIALIZATION PHASE       *
+    ************************************
+    *  Load the data that was created  *
+    *  for us during initialization.   *
+    ************************************/
+    uint p = bsp_pid();
+
+    nid_int edges_in_pid;   // Amount of edges in this process
+
+    nid_int amountOfNodes;  // Amount of vertices in the graph
+
+    nid_int (*local_edges)[2];
+    double   *local_weights = NULL;
+
+    // Part of the dictionary to the original vertex IDs of this process
+    struct id_dictionary *dict = NULL;
+
+    if (sparse) {
+        /* Steps a) to c)
+        **
+        ** Give every vertex a dense ID, and send every edge to the processes
+        ** of its endpoints.
+        */
+        local_edges = ingest_sparse_edges(input, &amountOfNodes,
+                                          &edges_in_pid, &dict);
+    } else {
+        bsp_push_reg(&edges_in_pid,  sizeof(nid_int));
+        bsp_push_reg(&amountOfNodes, sizeof(nid_int));
+
+        counted_sync();
+
+
+
+        /* Step a)
+        **
+        ** Tell each process how many vertices the graph has.
+        */
+        if (p == 0) {
+            amountOfNodes = input->nodes;
+
+            broadcast_total_node_amount(&amountOfNodes);
+        }
+        counted_sync();
+
+
+
+        /* Step b)
+        **
+        ** Calculate how many edges each process may expect.
+        */
+        if (p == 0) {
+            broadcast_edge_amount(input, &edges_in_pid);
+        }
+        counted_sync();
+
+        // DEBUG
+        // Check that every PID expects the right amount of edges.
+        debug_expected_amount_of_edges(edges_in_pid);
+
+
+
+        /* Step c)
+        **
+        ** Prepare to receive the edges.
+        */
+
+        // Set up the edge array
+        local_edges = local_malloc(2 * edges_in_pid * sizeof(nid_int));
+        bsp_push_reg(local_edges, 2 * edges_in_pid * sizeof(nid_int));
+
+        if (weighted) {
+            local_weights = local_malloc((edges_in_pid + 1) * sizeof(double));
+            bsp_push_reg(local_weights, edges_in_pid * sizeof(double));
+        }
+        counted_sync();
+
+        // Send the appropriate edges to the right processes
+        if (p == 0) {
+            send_edges(input, local_edges, local_weights);
+        }
+        counted_sync();
+
+        // DEBUG
+        // Check that every PID received the right edges.
+        debug_expected_edges(local_edges, edges_in_pid);
+
+        bsp_pop_reg(&edges_in_pid);
+        bsp_pop_reg(&amountOfNodes);
+        bsp_pop_reg(local_edges);
+
+        if (weighted) {
+            bsp_pop_reg(local_weights);
+        }
+    }
+
+
+
+    /* Step d)
+    **
+    ** Drop self-loops and duplicate edges, which would leave vertices with a
+    ** degree that is too high. Only the report needs communication.
+    */
+
+    double start_time = bsp_time();
+
+    double phase_start = bsp_time();
+    nid_int dropped[2];
+    edges_in_pid = clean_edges(local_edges, local_weights, edges_in_pid, 
+                               amountOfNodes, dropped);
+    record_phase(PHASE_CLEAN_EDGES, 0, phase_start);
+
+    nid_int self_loops = sum_across_processes(dropped[0]);
+    nid_int duplicates = sum_across_processes(dropped[1]);
+
+    if (p == 0) {
+        printf("Dropped " NID_FORMAT " self-loops and " NID_FORMAT 
+               " duplicate edges.\n", self_loops, duplicates);
+    }
+
+
+
+    /* Step e)
+    **
+    ** Set up the structure in the process. No communication is required here.
+    */
+
+    phase_start = bsp_time();
+    struct graph *g = load_structure(amountOfNodes, edges_in_pid, local_edges,
+                                     local_weights);
+    record_phase(PHASE_LOAD_STRUCTURE, 0, phase_start);
+
+    free(local_weights);
+
+    // DEBUG
+    // Check that the node have been initialised properly.
+    debug_graph_setup(g);
+
+    // Clean up memory. The validation at the end needs the input edges.
+    if (!options->validate) {
+        free(local_edges);
+    }
+
+    counted_sync();
+
+
+
+    /* Step f)
+    **
+    ** Match every small connected component on a single process. Only the
+    ** large components remain in the graph for the supersteps below. The
+    ** components are matched without their weights, so a weighted graph
+    ** goes through the supersteps as a whole.
+    */
+    if (options->small_components && !weighted) {
+        phase_start = bsp_time();
+        solve_small_components(g);
+        record_phase(PHASE_SMALL_COMPONENTS, 0, phase_start);
+    }
+
+
+
+
+    /***********************************
+    *            SUPERSTEP 1           *
+    ************************************
+    * Get rid of all nodes of degree 1 *
+    ************************************
+    *            SUPERSTEP 2           *
+    ************************************
+    * When no node of degree 1 is left *
+    * anywhere, match a batch of       *
+    * random edges and go back to      *
+    * superstep 1.                     *
+    ************************************
+    * A weighted graph skips superstep *
+    * 1, as the only edge of a node    *
+    * may be light, and matches the    *
+    * heaviest edges until none are    *
+    * left.                            *
+    ************************************/
+
+    // Optimistic processes need to find their edges to other processes.
+    if (options->optimistic) {
+        index_ghosts(g);
+    }
+
+    struct todo_list *todo = get_todo_list();
+    struct instruction *response;
+    nid_int round = 0;
+
+    while (true) {
+        if (stop_early(g, round, start_time, weighted)) {
+            unallocate_todo_list(todo);
+            break;
+        }
+
+        if (weighted) {
+            phase_start = bsp_time();
+            bool edges_left = match_dominant_edges(todo, g, round);
+            record_phase(PHASE_MATCH_DOMINANT_EDGES, round, phase_start);
+
+            if (!edges_left) {
+                unallocate_todo_list(todo);
+                break;
+            }
+        } else {
+            phase_start = bsp_time();
+            remove_singletons(todo, g);
+            record_phase(PHASE_REMOVE_SINGLETONS, round, phase_start);
+        }
+
+        phase_start = bsp_time();
+        response = send_instructions(todo);
+        record_phase(PHASE_SEND_INSTRUCTIONS, round, phase_start);
+
+        // // DEBUG
+        // // Check which responses were received
+        // debug_instruction_response(response, todo->expected_responses);
+
+        // Match random edges when communication has stopped. The graph is
+        // matched once no edges are left.
+        if (todo->expected_responses == 0 && !weighted) {
+            unallocate_todo_list(todo);
+            free(response);
+            todo = get_todo_list();
+
+            phase_start = bsp_time();
+            bool edges_left = match_dominant_edges(todo, g, round);
+            record_phase(PHASE_MATCH_DOMINANT_EDGES, round, phase_start);
+
+            if (!edges_left) {
+                unallocate_todo_list(todo);
+                break;
+            }
+
+            round++;
+            continue;
+        }
+
+        // Interpret the instructions. The instructions that they cause, such
+        // as the deletes of a node that was matched by a move, are sent in
+        // the next round.
+        struct todo_list *next = get_todo_list();
+
+        phase_start = bsp_time();
+        interpret_instructions(next, g, response, todo->expected_responses);
+        record_phase(PHASE_INTERPRET_INSTRUCTIONS, round, phase_start);
+
+        // // DEBUG
+        // // Check what the graph looks like now.
+        // counted_sync();
+        // debug_graph_setup(g);
+
+        // Clean up memory
+        unallocate_todo_list(todo);
+        free(response);
+        todo = next;
+
+        // // Debug break
+        // break;
+
+        round++;
+    }
+
+    debug_graph_setup(g);
+
+    // Report the size of the matching to the caller.
+    nid_int matches = sum_across_processes(g->m->length);
+    double  weight  = weighted ? sum_weight_across_processes(g->m->weight) : 0;
+    if (p == 0) {
+        RUNNING->matches = matches;
+        RUNNING->weight  = weight;
+        RUNNING->seconds = bsp_time() - start_time;
+    }
+
+    // Hand the matching to the caller. Every process sends its matches to
+    // the mate array that the first process registers.
+    if (RUNNING->mate != NULL) {
+        nid_int no_mate = NO_MATE;
+        nid_int *mate   = (p == 0) ? RUNNING->mate : &no_mate;
+
+        if (p == 0) {
+            for (nid_int v=0; v<amountOfNodes; v++) {
+                mate[v] = NO_MATE;
+            }
+        }
+
+        bsp_push_reg(mate, (p == 0) ? amountOfNodes * sizeof(nid_int) : 0);
+        counted_sync();
+
+        for (nid_int i=0; i<g->m->length; i++) {
+            nid_int a = g->m->matches[i][0];
+            nid_int b = g->m->matches[i][1];
+
+            counted_put(0, &b, mate, a * sizeof(nid_int), sizeof(nid_int));
+            counted_put(0, &a, mate, b * sizeof(nid_int), sizeof(nid_int));
+        }
+        counted_sync();
+
+        bsp_pop_reg(mate);
+        counted_sync();
+    }
+
+    if (options->validate) {
+        validate_matching(g, local_edges, edges_in_pid);
+        free(local_edges);
+    }
+
+    if (options->output_path != NULL) {
+        write_matching(g->m, dict, options->output_path);
+    }
+
+    if (dict != NULL) {
+        unallocate_id_dictionary(dict);
+    }
+
+    // // DEBUG
+    // // Check the graph's state after superstep 1
+    // unallocate_graph(g);
+
+
+
+    // Clean up memory
+    unallocate_graph(g);
+}
+
+/** PRIVATE
+ * Decide whether the supersteps may stop before the matching is maximal,
+ * because it is large enough or because time ran out. The matching is valid
+ * at the start of every round, so it can be handed over as it is.
+ *
+ * A match that a node of degree 1 forced is in some maximum matching of
+ * what was left of the graph. Any other match costs a maximum matching at
+ * most one edge, and every two vertices that are left may add one more. The
+ * processes share these counts in a single exchange, so that they all make
+ * the same choice.
+ *
+ * This bound counts edges, so it says nothing about the weight of a weighted
+ * matching. A weighted run only stops when its time budget runs out.
+ *
+ * All processes call this function together, unless neither the quality
+ * target nor the time budget is set.
+ *
+ * Parameters:
+ * - `g`            Graph structure.
+ * - `round`        Round of the superstep loop that is about to start.
+ * - `start_time`   Time at which the supersteps started.
+ * - `weighted`     Whether the graph has edge weights.
+ *
+ * Returns:         Whether to stop.
+ */
+bool stop_early(struct graph *g, nid_int round, double start_time,
+                bool weighted) {
+    struct matcher_options *options = &(RUNNING->options);
+
+    if (options->quality_target == 0 && options->time_budget == 0) {
+        return false;
+    }
+
+    bool late = options->time_budget > 0 && 
+                bsp_time() - start_time >= options->time_budget;
+
+    nid_int numbers[4] = {g->m->length, g->guessed, g->alive, late};
+    sum_numbers_across_processes(numbers, 4);
+
+    nid_int matches = numbers[0];
+    nid_int bound   = numbers[0] + numbers[1] + numbers[2] / 2;
+
+    // Without two vertices left, the supersteps end by themselves.
+    if (numbers[2] < 2) {
+        return false;
+    }
+
+    bool good = options->quality_target > 0 && !weighted &&
+                matches >= options->quality_target * bound;
+
+    if ((good || numbers[3] > 0) && g->pid == 0) {
+        if (weighted) {
+            printf("Stopped in round " NID_FORMAT " at the end of the time "
+                   "budget.\n", round);
+        } else {
+            printf("Stopped in round " NID_FORMAT " with a matching of at "
+                   "least %.1f%% of the maximum size.\n", 
+                   round, 100.0 * matches / bound);
+        }
+    }
+
+    return good || numbers[3] > 0;
+}
+
+/** PRIVATE
+ * Write the reports of a BSP session, right before the processes end.
+ */
+void end_session(void) {
+    struct matcher_options *options = &(RUNNING->options);
+
+    if (options->stats_path != NULL) {
+        report_stats(options->stats_path, options->g, options->l);
+    }
+    unallocate_stats();
+
+    if (options->timeline_path != NULL) {
+        report_timeline(options->timeline_path);
+    }
+    unallocate_timeline();
+    dump_trace();
+}
+
+/** PRIVATE
+ * Read the graphs of the next round of batch mode on the first process: one
+ * small graph for every process, or fewer if a large graph or the end of the
+ * input comes first.
+ *
+ * Parameters:
+ * - `rounds`   Array that will store the work of every process.
+ * - `small`    Array that will store the small graph of every process.
+ * - `large`    Will store the large graph, if any.
+ * - `graphs`   Amount of graphs read so far, which grows with this round.
+ */
+void read_batch_round(struct batch_round *rounds, struct input_graph *small,
+                      struct input_graph *large, nid_int *graphs) {
+    uint n = bsp_nprocs();
+
+    uint small_length = 0;
+    bool found_large  = false;
+    bool done         = false;
+
+    while (small_length < n && !found_large) {
+        struct input_graph input;
+
+        if (!scan_graph_size(&(input.nodes), &(input.edges_length))) {
+            done = true;
+            break;
+        }
+
+        input.edges        = malloc((input.edges_length + 1) * 2 * sizeof(nid_int));
+        input.sparse_edges = NULL;
+        input.weights      = NULL;
+        input.csr          = NULL;
+        prompt_edges(input.edges, input.edges_length);
+        (*graphs)++;
+
+        if (input.edges_length <= BATCH_SMALL_EDGES) {
+            rounds[small_length].graph = *graphs;
+            small[small_length]        = input;
+            small_length++;
+        } else {
+            *large      = input;
+            found_large = true;
+        }
+    }
+
+    // Processes without a small graph get an empty one.
+    for (uint i=small_length; i<n; i++) {
+        rounds[i].graph       = 0;
+        small[i].edges        = NULL;
+        small[i].edges_length = 0;
+    }
+
+    for (uint i=0; i<n; i++) {
+        rounds[i].solve        = (i < small_length);
+        rounds[i].edges_length = small[i].edges_length;
+        rounds[i].large        = found_large;
+        rounds[i].done         = done;
+    }
+}
+
+/** PRIVATE
+ * Match the small graph that this process gets in a round of batch mode, and
+ * print the size of its matching. All processes call this function together.
+ *
+ * Parameters:
+ * - `round`    Work of this process.
+ * - `small`    Small graph of every process. Only the first process reads it.
+ *
+ * Returns:     Size of the matching.
+ */
+nid_int solve_batch_round(struct batch_round *round, struct input_graph *small) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    nid_int (*edges)[2] = malloc((round->edges_length + 1) * 2 * sizeof(nid_int));
+    bsp_push_reg(edges, round->edges_length * 2 * sizeof(nid_int));
+    counted_sync();
+
+    if (p == 0) {
+        for (uint i=0; i<n; i++) {
+            if (small[i].edges_length > 0) {
+                counted_put(i, small[i].edges, edges, 0,
+                            small[i].edges_length * 2 * sizeof(nid_int));
+            }
+        }
+    }
+    counted_sync();
+
+    // Every small graph was sent, so the first process can let go of them.
+    if (p == 0) {
+        for (uint i=0; i<n; i++) {
+            free(small[i].edges);
+        }
+    }
+
+    nid_int matches = 0;
+
+    if (round->solve) {
+        double start_time  = bsp_time();
+        struct matching *m = create_matching(round->edges_length / 2 + 1);
+
+        match_sequential(edges, round->edges_length, m);
+        matches = m->length;
+
+        printf("Graph " NID_FORMAT ": matching of " NID_FORMAT " edges in "
+               "%.6f seconds.\n", 
+               round->graph, matches, bsp_time() - start_time);
+        fflush(stdout);
+
+        unallocate_matching(m);
+    }
+
+    bsp_pop_reg(edges);
+    counted_sync();
+    free(edges);
+
+    return matches;
+}
@@ -0,0 +1,140 @@
+
+/**
+ * Get the default settings of a matcher: every core as a BSP process with a
+ * single thread, block distribution, and no reports.
+ *
+ * Returns:     Settings of a matcher.
+ */
+struct matcher_options default_matcher_options(void);
+
+/**
+ * Create a matcher that can match several graphs, one after the other. Only
+ * one matcher may run at a time.
+ *
+ * Parameters:
+ * - `options`  Settings of the matcher.
+ *
+ * Returns:     Matcher, or NULL if the settings are invalid.
+ */
+struct matcher *create_matcher(struct matcher_options options);
+
+/**
+ * Find a maximal matching in a graph that is given as an array of edges. The
+ * matcher reads the array without copying it.
+ *
+ * Parameters:
+ * - `mt`           Matcher.
+ * - `nodes`        Amount of vertices in the graph.
+ * - `edges`        Array of edges, with vertices counted from 0.
+ * - `edges_length` Array length of `edges`.
+ * - `mate`         Array of length `nodes` that will store the partner of
+ *                  every vertex, or NO_MATE. May be NULL.
+ *
+ * Returns:         Amount of edges in the matching.
+ */
+nid_int match_edges(struct matcher *mt, nid_int nodes, nid_int (*edges)[2],
+                    nid_int edges_length, nid_int *mate);
+
+/**
+ * Find a maximal matching in a graph that is given as a graph structure. The
+ * structure must list every edge in both directions. The matcher reads it
+ * without copying it.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ * - `csr`      Graph structure.
+ * - `mate`     Array of length `csr->nodes` that will store the partner of
+ *              every vertex, or NO_MATE. May be NULL.
+ *
+ * Returns:     Amount of edges in the matching.
+ */
+nid_int match_csr(struct matcher *mt, const struct csr_graph *csr,
+                  nid_int *mate);
+
+/**
+ * Find a maximal matching in a graph whose vertices have arbitrary IDs, for
+ * example 64-bit hashes. The matcher gives the vertices dense IDs first, and
+ * writes the matching with the original IDs to the output file, if any. The
+ * matcher reads the array without copying it.
+ *
+ * Parameters:
+ * - `mt`           Matcher.
+ * - `edges`        Array of edges between original vertex IDs.
+ * - `edges_length` Array length of `edges`.
+ *
+ * Returns:         Amount of edges in the matching.
+ */
+nid_int match_sparse_edges(struct matcher *mt, xid_int (*edges)[2],
+                           nid_int edges_length);
+
+/**
+ * Find a matching of high weight in a weighted graph that is given as an
+ * array of edges. The matching has at least half the weight of a maximum
+ * weight matching, and is maximal. The matcher reads the arrays without
+ * copying them.
+ *
+ * Only the BSP backend matches weighted graphs. A quality target can't be
+ * set, as the bound of the anytime mode counts edges and not weight. A time
+ * budget can.
+ *
+ * Parameters:
+ * - `mt`           Matcher.
+ * - `nodes`        Amount of vertices in the graph.
+ * - `edges`        Array of edges, with vertices counted from 0.
+ * - `weights`      Weight of every edge.
+ * - `edges_length` Array length of `edges` and `weights`.
+ * - `mate`         Array of length `nodes` that will store the partner of
+ *                  every vertex, or NO_MATE. May be NULL.
+ *
+ * Returns:         Amount of edges in the matching. See `matcher_weight()`
+ *                  for its weight.
+ */
+nid_int match_weighted_edges(struct matcher *mt, nid_int nodes,
+                             nid_int (*edges)[2], double *weights,
+                             nid_int edges_length, nid_int *mate);
+
+/**
+ * Match every graph on stdin in a single BSP session, and print the size of
+ * every matching as soon as it is found. The graphs follow each other in the
+ * input format, without asking for them.
+ *
+ * Small graphs are matched on a single process each, so that the processes
+ * match as many graphs at the same time. Large graphs go through the
+ * distributed supersteps, one at a time.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ *
+ * Returns:     Amount of graphs.
+ */
+nid_int match_batch(struct matcher *mt);
+
+/**
+ * Get the duration of the last run of a matcher, without handing over the
+ * graph.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ *
+ * Returns:     Duration in seconds.
+ */
+double matcher_seconds(struct matcher *mt);
+
+/**
+ * Get the total weight of the matching of the last run of a matcher on a
+ * weighted graph.
+ *
+ * Parameters:
+ * - `mt`       Matcher.
+ *
+ * Returns:     Total weight of the matching.
+ */
+double matcher_weight(struct matcher *mt);
+
+/**
+ * Unallocate a matcher.
+ *
+ * Parameters:
+ * - `mt`       The matcher that is to be freed from memory.
+ */
+void unallocate_matcher(struct matcher *mt);
@@ -0,0 +1,212 @@
+#include "ingest.h"
+#include "output.h"
+#include "stats.h"
+
+// PRIVATE FUNCTIONS
+char *format_matches(struct matching *m, xid_int (*restored)[2],
+                     size_t *text_length);
+size_t exchange_file_offset(size_t text_length);
+
+/**
+ * Write the matches of all processes to disk, with vertices counted from 1
+ * like in the input. Every line holds the two vertices of a match.
+ *
+ * If `path` contains `%u`, every process writes its own file, with its PID in
+ * place of `%u`. Otherwise, all processes write their part of a single file
+ * at the same time, at an offset that follows from the sizes of the parts of
+ * the processes before them.
+ *
+ * With a dictionary, the matches are written with the original vertex IDs of
+ * the input instead.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `m`        Matching structure of this process.
+ * - `dict`     Part of the dictionary of this process, or NULL if the input
+ *              had dense vertex IDs.
+ * - `path`     File to write to.
+ *
+ * Returns:     Whether this process could write its matches.
+ */
+bool write_matching(struct matching *m, struct id_dictionary *dict,
+                    const char *path) {
+    xid_int (*restored)[2] = NULL;
+
+    if (dict != NULL) {
+        restored = restore_ids(dict, m);
+    }
+
+    size_t text_length;
+    char *text = format_matches(m, restored, &text_length);
+    bool written;
+
+    free(restored);
+
+    char *pid_in_path = strstr(path, "%u");
+
+    if (pid_in_path != NULL) {
+        char own_path[4096];
+        snprintf(own_path, sizeof(own_path), "%.*s%u%s", 
+                 (int) (pid_in_path - path), path, bsp_pid(), 
+                 pid_in_path + 2);
+
+        FILE *file = fopen(own_path, "w");
+        written    = (file != NULL && 
+                      fwrite(text, 1, text_length, file) == text_length);
+
+        if (file != NULL) {
+            fclose(file);
+        }
+    } else {
+        size_t offset = exchange_file_offset(text_length);
+
+        // PID 0 empties the file before anyone writes to it.
+        if (bsp_pid() == 0) {
+            int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        counted_sync();
+
+        int fd  = open(path, O_WRONLY);
+        written = (fd >= 0);
+
+        for (size_t done=0; written && done<text_length; ) {
+            ssize_t size = pwrite(fd, &(text[done]), text_length - done, 
+                                  offset + done);
+
+            written = (size > 0);
+            done    = done + (written ? size : 0);
+        }
+
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    if (!written) {
+        fprintf(stderr, "[PID %u] Cannot write the matching to %s.\n", 
+                bsp_pid(), path);
+    }
+
+    free(text);
+    return written;
+}
+
+/**
+ * Write a matching in shared memory to a file, with vertices counted from 1,
+ * or with their original IDs if the input had sparse vertex IDs.
+ *
+ * Parameters:
+ * - `mate`         Partner of every vertex, or NO_MATE.
+ * - `nodes`        Array length of parameter `mate`.
+ * - `ids`          Original ID of every vertex, or NULL.
+ * - `path`         File to write to.
+ *
+ * Returns:         Whether the file could be written.
+ */
+bool write_mates(nid_int *mate, nid_int nodes, const xid_int *ids,
+                 const char *path) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write the matching to %s.\n", path);
+        return false;
+    }
+
+    for (nid_int v=0; v<nodes; v++) {
+        if (mate[v] == NO_MATE || v > mate[v]) {
+            continue;
+        }
+
+        if (ids != NULL) {
+            fprintf(file, XID_FORMAT " " XID_FORMAT "\n", ids[v], ids[mate[v]]);
+        } else {
+            fprintf(file, NID_FORMAT " " NID_FORMAT "\n", v + 1, mate[v] + 1);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Format all matches of this process as text.
+ *
+ * Parameters:
+ * - `m`            Matching structure.
+ * - `restored`     Original IDs of the matches, or NULL.
+ * - `text_length`  Integer that will store the length of the text.
+ *
+ * Returns:         The text, without a terminating null character.
+ */
+char *format_matches(struct matching *m, xid_int (*restored)[2],
+                     size_t *text_length) {
+    // Two numbers, a space, a newline and the closing null character.
+    size_t max_line = 2 * XID_DIGITS + 3;
+    char *text      = malloc(m->length * max_line + 1);
+    size_t length   = 0;
+
+    for (nid_int i=0; i<m->length; i++) {
+        if (restored != NULL) {
+            length = length + snprintf(&(text[length]), max_line + 1,
+                                       XID_FORMAT " " XID_FORMAT "\n",
+                                       restored[i][0], restored[i][1]);
+        } else {
+            length = length + snprintf(&(text[length]), max_line + 1, 
+                                       NID_FORMAT " " NID_FORMAT "\n",
+                                       m->matches[i][0] + 1, 
+                                       m->matches[i][1] + 1);
+        }
+    }
+
+    *text_length = length;
+    return text;
+}
+
+/** PRIVATE
+ * Find where this process may write its part of a shared file: after the
+ * parts of all processes with a lower PID.
+ *
+ * Parameters:
+ * - `text_length`  Size in bytes of the part of this process.
+ *
+ * Returns:         Offset in bytes of the part of this process.
+ */
+size_t exchange_file_offset(size_t text_length) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    size_t *lengths = malloc(n * sizeof(size_t));
+    bsp_push_reg(lengths, n * sizeof(size_t));
+    counted_sync();
+
+    for (uint i=0; i<n; i++) {
+        counted_put(i, &text_length, lengths, p * sizeof(size_t), 
+                    sizeof(size_t));
+    }
+    counted_sync();
+    bsp_pop_reg(lengths);
+
+    size_t offset = 0;
+    for (uint i=0; i<p; i++) {
+        offset = offset + lengths[i];
+    }
+
+    free(lengths);
+    return offset;
+}
@@ -0,0 +1,40 @@
+
+/**
+ * Write the matches of all processes to disk, with vertices counted from 1
+ * like in the input. Every line holds the two vertices of a match.
+ *
+ * If `path` contains `%u`, every process writes its own file, with its PID in
+ * place of `%u`. Otherwise, all processes write their part of a single file
+ * at the same time, at an offset that follows from the sizes of the parts of
+ * the processes before them.
+ *
+ * With a dictionary, the matches are written with the original vertex IDs of
+ * the input instead.
+ *
+ * Every process needs to call this function.
+ *
+ * Parameters:
+ * - `m`        Matching structure of this process.
+ * - `dict`     Part of the dictionary of this process, or NULL if the input
+ *              had dense vertex IDs.
+ * - `path`     File to write to.
+ *
+ * Returns:     Whether this process could write its matches.
+ */
+bool write_matching(struct matching *m, struct id_dictionary *dict,
+                    const char *path);
+
+/**
+ * Write a matching in shared memory to a file, with vertices counted from 1,
+ * or with their original IDs if the input had sparse vertex IDs.
+ *
+ * Parameters:
+ * - `mate`         Partner of every vertex, or NO_MATE.
+ * - `nodes`        Array length of parameter `mate`.
+ * - `ids`          Original ID of every vertex, or NULL.
+ * - `path`         File to write to.
+ *
+ * Returns:         Whether the file could be written.
+ */
+bool write_mates(nid_int *mate, nid_int nodes, const xid_int *ids,
+                 const char *path);
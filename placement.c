@@ -0,0 +1,251 @@
+#include "placement.h"
+#include "stats.h"
+
+// Cores that processes and threads are pinned to. NULL if nothing is pinned.
+static int  *PINNED_CORES        = NULL;
+static uint  PINNED_CORES_LENGTH = 0;
+
+// PRIVATE FUNCTIONS
+int numa_node_of_core(int core);
+void pin_to_cores(int *cores, uint cores_length);
+
+/**
+ * Read a list of cores from text such as "0-3,8,10-11".
+ *
+ * Parameters:
+ * - `text`     Comma-separated cores and ranges of cores.
+ * - `cores`    Pointer that will store a newly allocated array of cores.
+ *
+ * Returns:     Array length of parameter `cores`, or 0 if the text is invalid.
+ */
+uint parse_core_list(const char *text, int **cores) {
+    uint length   = 0;
+    uint capacity = 16;
+    *cores        = malloc(capacity * sizeof(int));
+
+    while (*text != '\0') {
+        char *end;
+        long first = strtol(text, &end, 10);
+        long last  = first;
+
+        if (end == text || first < 0) {
+            free(*cores);
+            return 0;
+        }
+        text = end;
+
+        if (*text == '-') {
+            last = strtol(text + 1, &end, 10);
+
+            if (end == text + 1 || last < first) {
+                free(*cores);
+                return 0;
+            }
+            text = end;
+        }
+
+        for (long core=first; core<=last; core++) {
+            if (length == capacity) {
+                capacity = 2 * capacity;
+                *cores   = realloc(*cores, capacity * sizeof(int));
+            }
+            (*cores)[length] = core;
+            length++;
+        }
+
+        if (*text == ',') {
+            text++;
+        } else if (*text != '\0') {
+            free(*cores);
+            return 0;
+        }
+    }
+
+    return length;
+}
+
+/**
+ * Set the cores that processes and threads will be pinned to.
+ *
+ * Without a core list, nothing is pinned and the operating system decides
+ * where everything runs.
+ *
+ * Parameters:
+ * - `cores`        Array of cores.
+ * - `cores_length` Array length of parameter `cores`.
+ */
+void set_core_list(int *cores, uint cores_length) {
+    PINNED_CORES        = cores;
+    PINNED_CORES_LENGTH = cores_length;
+}
+
+/**
+ * Pin this BSP process to its own cores.
+ *
+ * Process `p` gets the cores `p * threads` up to `(p + 1) * threads` of the
+ * core list. The threads that the process starts later inherit these cores.
+ *
+ * Parameters:
+ * - `threads`  Amount of threads within each process.
+ */
+void pin_process(uint threads) {
+    if (PINNED_CORES == NULL) {
+        return;
+    }
+
+    uint first = (bsp_pid() * threads) % PINNED_CORES_LENGTH;
+    uint count = (threads < PINNED_CORES_LENGTH - first) ? 
+                  threads : PINNED_CORES_LENGTH - first;
+
+    pin_to_cores(&(PINNED_CORES[first]), count);
+}
+
+/**
+ * Pin every thread of the next parallel regions to its own core, and print
+ * where every thread runs.
+ *
+ * This is used by the shared-memory backend, which has no BSP processes.
+ */
+void pin_threads(void) {
+    if (PINNED_CORES == NULL) {
+        return;
+    }
+
+    uint threads = max_thread_count();
+    int *placement = malloc(threads * sizeof(int));
+
+    OMP(omp parallel)
+    {
+        pin_to_cores(&(PINNED_CORES[thread_id() % PINNED_CORES_LENGTH]), 1);
+        placement[thread_id()] = sched_getcpu();
+    }
+
+    printf("Placement of the threads:\n");
+
+    for (uint t=0; t<threads; t++) {
+        printf("[Thread %u] core %d, NUMA node %d\n", 
+               t, placement[t], numa_node_of_core(placement[t]));
+    }
+
+    free(placement);
+}
+
+/**
+ * Print on which core and NUMA node every process runs.
+ *
+ * Every process needs to call this function, but only PID 0 prints.
+ */
+void report_placement(void) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    int  here[2]   = {sched_getcpu(), 0};
+    int *placement = malloc(2 * n * sizeof(int));
+
+    here[1] = numa_node_of_core(here[0]);
+
+    bsp_push_reg(placement, 2 * n * sizeof(int));
+    counted_sync();
+
+    counted_put(0, here, placement, 2 * p * sizeof(int), 2 * sizeof(int));
+    counted_sync();
+
+    if (p == 0) {
+        printf("Placement of the processes:\n");
+
+        for (uint i=0; i<n; i++) {
+            printf("[PID %u] core %d, NUMA node %d\n", 
+                   i, placement[2*i], placement[2*i+1]);
+        }
+    }
+
+    bsp_pop_reg(placement);
+    free(placement);
+}
+
+/**
+ * Allocate memory on the NUMA node of the calling thread.
+ *
+ * Linux places a page on the NUMA node of the thread that first writes to it.
+ * When processes are pinned, this function writes to every page right away,
+ * so that the memory is local even if other processes write to it first
+ * later on, like they do with `bsp_put`.
+ *
+ * Parameters:
+ * - `size`     Amount of bytes to allocate.
+ *
+ * Returns:     Pointer to the allocated memory.
+ */
+void *local_malloc(size_t size) {
+    void *memory = malloc(size);
+
+    if (PINNED_CORES != NULL && memory != NULL) {
+        memset(memory, 0, size);
+    }
+
+    return memory;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Look up the NUMA node that a core belongs to.
+ *
+ * Parameters:
+ * - `core`     Core number.
+ *
+ * Returns:     The NUMA node, or -1 if it is unknown.
+ */
+int numa_node_of_core(int core) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", core);
+
+    DIR *directory = opendir(path);
+    if (directory == NULL) {
+        return -1;
+    }
+
+    // The directory contains a link called `node<N>`.
+    int node = -1;
+    struct dirent *entry;
+
+    while ((entry = readdir(directory)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 &&
+            entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(&(entry->d_name[4]));
+            break;
+        }
+    }
+
+    closedir(directory);
+    return node;
+}
+
+/** PRIVATE
+ * Pin the calling thread to a set of cores.
+ *
+ * Parameters:
+ * - `cores`        Array of cores.
+ * - `cores_length` Array length of parameter `cores`.
+ */
+void pin_to_cores(int *cores, uint cores_length) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (uint i=0; i<cores_length; i++) {
+        CPU_SET(cores[i], &set);
+    }
+
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+        fprintf(stderr, "Cannot pin a thread to core %d.\n", cores[0]);
+    }
+}
@@ -0,0 +1,64 @@
+
+/**
+ * Read a list of cores from text such as "0-3,8,10-11".
+ *
+ * Parameters:
+ * - `text`     Comma-separated cores and ranges of cores.
+ * - `cores`    Pointer that will store a newly allocated array of cores.
+ *
+ * Returns:     Array length of parameter `cores`, or 0 if the text is invalid.
+ */
+uint parse_core_list(const char *text, int **cores);
+
+/**
+ * Set the cores that processes and threads will be pinned to.
+ *
+ * Without a core list, nothing is pinned and the operating system decides
+ * where everything runs.
+ *
+ * Parameters:
+ * - `cores`        Array of cores.
+ * - `cores_length` Array length of parameter `cores`.
+ */
+void set_core_list(int *cores, uint cores_length);
+
+/**
+ * Pin this BSP process to its own cores.
+ *
+ * Process `p` gets the cores `p * threads` up to `(p + 1) * threads` of the
+ * core list. The threads that the process starts later inherit these cores.
+ *
+ * Parameters:
+ * - `threads`  Amount of threads within each process.
+ */
+void pin_process(uint threads);
+
+/**
+ * Pin every thread of the next parallel regions to its own core, and print
+ * where every thread runs.
+ *
+ * This is used by the shared-memory backend, which has no BSP processes.
+ */
+void pin_threads(void);
+
+/**
+ * Print on which core and NUMA node every process runs.
+ *
+ * Every process needs to call this function, but only PID 0 prints.
+ */
+void report_placement(void);
+
+/**
+ * Allocate memory on the NUMA node of the calling thread.
+ *
+ * Linux places a page on the NUMA node of the thread that first writes to it.
+ * When processes are pinned, this function writes to every page right away,
+ * so that the memory is local even if other processes write to it first
+ * later on, like they do with `bsp_put`.
+ *
+ * Parameters:
+ * - `size`     Amount of bytes to allocate.
+ *
+ * Returns:     Pointer to the allocated memory.
+ */
+void *local_malloc(size_t size);
@@ -0,0 +1,187 @@
+// Measure the BSP machine parameters g and l of this machine.
+//
+// Usage:     ./probe [-p processes] [file]
+//
+// Like bspbench, every process sends h single words to the other processes
+// in every superstep, for every h-relation up to PROBE_MAX_H words. The
+// program fits the line l + g*h through the measured times. It prints the
+// measurements and writes g and l to the file (default: bsp.params), which
+// the matcher reads with its -m option.
+#include <bsp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "main.h"
+
+static unsigned int AMOUNT_OF_CORES = 0;
+static char        *PARAMETERS_PATH = "bsp.params";
+
+// PRIVATE FUNCTIONS
+void fit_parameters(double *times, double *g, double *l);
+void write_parameters(const char *path, double g, double l);
+
+/**
+ * Function that runs synchronously on multiple cores.
+ */
+void spmd(void) {
+    bsp_begin(AMOUNT_OF_CORES);
+
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    double *src   = malloc(PROBE_MAX_H * sizeof(double));
+    double *dest  = malloc(n * PROBE_MAX_H * sizeof(double));
+    double *times = malloc((PROBE_MAX_H + 1) * sizeof(double));
+
+    for (uint i=0; i<PROBE_MAX_H; i++) {
+        src[i] = p + i;
+    }
+
+    bsp_push_reg(dest, n * PROBE_MAX_H * sizeof(double));
+    bsp_sync();
+
+    for (uint h=0; h<=PROBE_MAX_H; h++) {
+        double start = bsp_time();
+
+        for (uint k=0; k<PROBE_ITERATIONS; k++) {
+            // Every process receives as many words as it sends, which makes
+            // this a full h-relation.
+            for (uint i=0; i<h; i++) {
+                uint q = (n == 1) ? 0 : (p + 1 + i % (n - 1)) % n;
+
+                bsp_put(q, &(src[i]), dest, (p * PROBE_MAX_H + i) * sizeof(double),
+                        sizeof(double));
+            }
+            bsp_sync();
+        }
+
+        times[h] = (bsp_time() - start) / PROBE_ITERATIONS;
+    }
+
+    bsp_pop_reg(dest);
+    bsp_sync();
+
+    if (p == 0) {
+        double g;
+        double l;
+        fit_parameters(times, &g, &l);
+
+        printf("Measured %u processes with h-relations of up to %u words:\n",
+               n, PROBE_MAX_H);
+        printf("        h   time (s)\n");
+
+        for (uint h=0; h<=PROBE_MAX_H; h = (h == 0) ? 1 : 2 * h) {
+            printf("%9u %10.3e\n", h, times[h]);
+        }
+
+        printf("g = %.3e s/byte\nl = %.3e s\n", g, l);
+        write_parameters(PARAMETERS_PATH, g, l);
+    }
+
+    free(src);
+    free(dest);
+    free(times);
+
+    bsp_end();
+}
+
+/**
+ * Setup function
+ */
+int main(int argc, char **argv) {
+    int option;
+
+    while ((option = getopt(argc, argv, "p:")) != -1) {
+        if (option == 'p') {
+            AMOUNT_OF_CORES = strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-p processes] [file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind < argc) {
+        PARAMETERS_PATH = argv[optind];
+    }
+
+    // Measure all cores unless asked otherwise.
+    if (AMOUNT_OF_CORES == 0 || AMOUNT_OF_CORES > bsp_nprocs()) {
+        AMOUNT_OF_CORES = bsp_nprocs();
+    }
+
+    bsp_init(&spmd, argc, argv);
+    spmd();
+
+    return EXIT_SUCCESS;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Fit the line l + g*h through the measured times with least squares.
+ *
+ * Parameters:
+ * - `times`    Time of a superstep for every h-relation in words.
+ * - `g`        Will store the time in seconds to communicate one byte.
+ * - `l`        Will store the time in seconds of a synchronisation.
+ */
+void fit_parameters(double *times, double *g, double *l) {
+    double count = PROBE_MAX_H + 1;
+    double sum_h = 0;
+    double sum_t = 0;
+    double sum_hh = 0;
+    double sum_ht = 0;
+
+    for (uint h=0; h<=PROBE_MAX_H; h++) {
+        sum_h  = sum_h  + h;
+        sum_t  = sum_t  + times[h];
+        sum_hh = sum_hh + (double) h * h;
+        sum_ht = sum_ht + h * times[h];
+    }
+
+    double slope = (count * sum_ht - sum_h * sum_t) /
+                   (count * sum_hh - sum_h * sum_h);
+
+    // The matcher counts communication in bytes, not in words.
+    *g = slope / sizeof(double);
+    *l = (sum_t - slope * sum_h) / count;
+
+    // Noise can push the fit below zero on an idle machine.
+    *g = (*g < 0) ? 0 : *g;
+    *l = (*l < 0) ? times[0] : *l;
+}
+
+/** PRIVATE
+ * Write the BSP machine parameters to a file that the matcher can read.
+ *
+ * Parameters:
+ * - `path`     File to write to.
+ * - `g`        Time in seconds to communicate one byte.
+ * - `l`        Time in seconds of a synchronisation.
+ */
+void write_parameters(const char *path, double g, double l) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write the BSP parameters to %s.\n", path);
+        return;
+    }
+
+    fprintf(file, "# BSP parameters of %u processes, measured by probe\n",
+            bsp_nprocs());
+    fprintf(file, "g %.6e\n", g);
+    fprintf(file, "l %.6e\n", l);
+
+    fclose(file);
+}
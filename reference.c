@@ -0,0 +1,280 @@
+// Find the size of a maximum matching with Edmonds' blossom algorithm.
+//
+// Compile:   gcc -O2 -o reference reference.c
+// Usage:     ./reference < graph.input
+//
+// The graph is read from stdin in the input format of the matcher. This
+// program is slow but exact, and serves as the reference that the matcher is
+// tested against on small graphs.
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "main.h"
+
+// PRIVATE FUNCTIONS
+bool augment_from(struct csr_graph *csr, nid_int *mate, nid_int root,
+                  nid_int *parent, nid_int *base, nid_int *queue,
+                  bool *used, bool *blossom);
+nid_int common_base(nid_int *mate, nid_int *parent, nid_int *base,
+                    nid_int nodes, nid_int a, nid_int b);
+void mark_path(nid_int *mate, nid_int *parent, nid_int *base, bool *blossom,
+               nid_int v, nid_int b, nid_int child);
+struct csr_graph *read_graph(void);
+
+/**
+ * Read a graph from stdin and print the size of a maximum matching.
+ */
+int main(void) {
+    struct csr_graph *csr = read_graph();
+
+    if (csr == NULL) {
+        fprintf(stderr, "Cannot read the graph.\n");
+        return EXIT_FAILURE;
+    }
+
+    nid_int nodes   = csr->nodes;
+    nid_int *mate   = malloc((nodes + 1) * sizeof(nid_int));
+    nid_int *parent = malloc((nodes + 1) * sizeof(nid_int));
+    nid_int *base   = malloc((nodes + 1) * sizeof(nid_int));
+    nid_int *queue  = malloc((nodes + 1) * sizeof(nid_int));
+    bool *used      = malloc((nodes + 1) * sizeof(bool));
+    bool *blossom   = malloc((nodes + 1) * sizeof(bool));
+    nid_int matches = 0;
+
+    for (nid_int v=0; v<nodes; v++) {
+        mate[v] = NO_MATE;
+    }
+
+    // A greedy start leaves fewer augmenting paths to search for.
+    for (nid_int v=0; v<nodes; v++) {
+        for (nid_int j=csr->offsets[v]; j<csr->offsets[v+1] &&
+                                       mate[v] == NO_MATE; j++) {
+            nid_int w = csr->targets[j];
+
+            if (w != v && mate[w] == NO_MATE) {
+                mate[v] = w;
+                mate[w] = v;
+                matches++;
+            }
+        }
+    }
+
+    for (nid_int v=0; v<nodes; v++) {
+        if (mate[v] == NO_MATE &&
+            augment_from(csr, mate, v, parent, base, queue, used, blossom)) {
+            matches++;
+        }
+    }
+
+    printf("Maximum matching of " NID_FORMAT " edges.\n", matches);
+
+    free(mate);
+    free(parent);
+    free(base);
+    free(queue);
+    free(used);
+    free(blossom);
+    free(csr->offsets);
+    free(csr->targets);
+    free(csr);
+
+    return EXIT_SUCCESS;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Search for an augmenting path from a free vertex, and flip it if it exists.
+ *
+ * The search grows an alternating tree in breadth-first order. Odd cycles
+ * (blossoms) are contracted onto their base as they are found.
+ *
+ * Parameters:
+ * - `csr`      Graph structure.
+ * - `mate`     Partner of every vertex, or NO_MATE.
+ * - `root`     Free vertex to start from.
+ * - `parent`   Work array for the tree of the search.
+ * - `base`     Work array for the base of each vertex's blossom.
+ * - `queue`    Work array for the breadth-first search.
+ * - `used`     Work array for the vertices in the tree.
+ * - `blossom`  Work array for the vertices in a blossom.
+ *
+ * Returns:     Whether the matching grew by one edge.
+ */
+bool augment_from(struct csr_graph *csr, nid_int *mate, nid_int root,
+                  nid_int *parent, nid_int *base, nid_int *queue,
+                  bool *used, bool *blossom) {
+    nid_int nodes = csr->nodes;
+
+    for (nid_int v=0; v<nodes; v++) {
+        parent[v] = NO_MATE;
+        base[v]   = v;
+        used[v]   = false;
+    }
+
+    nid_int head = 0;
+    nid_int tail = 0;
+
+    used[root]    = true;
+    queue[tail++] = root;
+
+    while (head < tail) {
+        nid_int v = queue[head++];
+
+        for (nid_int j=csr->offsets[v]; j<csr->offsets[v+1]; j++) {
+            nid_int to = csr->targets[j];
+
+            if (base[v] == base[to] || mate[v] == to) {
+                continue;
+            }
+
+            if (to == root || (mate[to] != NO_MATE &&
+                               parent[mate[to]] != NO_MATE)) {
+                // Found an odd cycle: contract it onto its base.
+                nid_int b = common_base(mate, parent, base, nodes, v, to);
+
+                for (nid_int u=0; u<nodes; u++) {
+                    blossom[u] = false;
+                }
+                mark_path(mate, parent, base, blossom, v,  b, to);
+                mark_path(mate, parent, base, blossom, to, b, v);
+
+                for (nid_int u=0; u<nodes; u++) {
+                    if (blossom[base[u]]) {
+                        base[u] = b;
+
+                        if (!used[u]) {
+                            used[u]       = true;
+                            queue[tail++] = u;
+                        }
+                    }
+                }
+            } else if (parent[to] == NO_MATE) {
+                parent[to] = v;
+
+                if (mate[to] == NO_MATE) {
+                    // Flip the augmenting path that ends in `to`.
+                    while (to != NO_MATE) {
+                        nid_int pv   = parent[to];
+                        nid_int next = mate[pv];
+
+                        mate[to] = pv;
+                        mate[pv] = to;
+                        to       = next;
+                    }
+                    return true;
+                }
+
+                used[mate[to]] = true;
+                queue[tail++]  = mate[to];
+            }
+        }
+    }
+
+    return false;
+}
+
+/** PRIVATE
+ * Find the base of the blossom that closes when vertices `a` and `b` of the
+ * alternating tree are joined.
+ */
+nid_int common_base(nid_int *mate, nid_int *parent, nid_int *base,
+                    nid_int nodes, nid_int a, nid_int b) {
+    bool *seen = calloc(nodes + 1, sizeof(bool));
+
+    while (true) {
+        a       = base[a];
+        seen[a] = true;
+
+        if (mate[a] == NO_MATE) {
+            break;
+        }
+        a = parent[mate[a]];
+    }
+
+    while (!seen[base[b]]) {
+        b = parent[mate[base[b]]];
+    }
+
+    free(seen);
+    return base[b];
+}
+
+/** PRIVATE
+ * Mark the blossoms on the path from `v` to the base `b`, and point the tree
+ * along the path towards `child`.
+ */
+void mark_path(nid_int *mate, nid_int *parent, nid_int *base, bool *blossom,
+               nid_int v, nid_int b, nid_int child) {
+    while (base[v] != b) {
+        blossom[base[v]]       = true;
+        blossom[base[mate[v]]] = true;
+
+        parent[v] = child;
+        child     = mate[v];
+        v         = parent[mate[v]];
+    }
+}
+
+/** PRIVATE
+ * Read a graph from stdin into a compressed adjacency structure. Vertices are
+ * counted from 1 in the input, and from 0 in the structure.
+ *
+ * Returns:     Graph structure, or NULL if the input is invalid.
+ */
+struct csr_graph *read_graph(void) {
+    nid_int nodes;
+    nid_int edges;
+
+    if (scanf(NID_FORMAT " " NID_FORMAT, &nodes, &edges) != 2) {
+        return NULL;
+    }
+
+    nid_int (*list)[2] = malloc((edges + 1) * 2 * sizeof(nid_int));
+
+    for (nid_int i=0; i<edges; i++) {
+        if (scanf(NID_FORMAT " " NID_FORMAT, &(list[i][0]), &(list[i][1])) != 2 ||
+            list[i][0] == 0 || list[i][0] > nodes ||
+            list[i][1] == 0 || list[i][1] > nodes) {
+            free(list);
+            return NULL;
+        }
+        list[i][0]--;
+        list[i][1]--;
+    }
+
+    struct csr_graph *csr = malloc(sizeof(struct csr_graph));
+
+    csr->nodes   = nodes;
+    csr->offsets = calloc(nodes + 2, sizeof(nid_int));
+    csr->targets = malloc((2 * edges + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<edges; i++) {
+        csr->offsets[list[i][0] + 2]++;
+        csr->offsets[list[i][1] + 2]++;
+    }
+    for (nid_int v=2; v<=nodes+1; v++) {
+        csr->offsets[v] = csr->offsets[v] + csr->offsets[v-1];
+    }
+    for (nid_int i=0; i<edges; i++) {
+        nid_int a = list[i][0];
+        nid_int b = list[i][1];
+
+        csr->targets[csr->offsets[a+1]++] = b;
+        csr->targets[csr->offsets[b+1]++] = a;
+    }
+
+    free(list);
+    return csr;
+}
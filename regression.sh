@@ -0,0 +1,134 @@
+#!/bin/sh
+# Test the matcher for correctness and speed with several amounts of processes.
+#
+# Usage: ./regression.sh <binary> <reference> <generator>
+#
+# Every input in testcases/ and a set of generated graphs is matched with
+# 1, 2, 4, ... processes, up to MAX_PROCESSES. The matcher validates its own
+# matching (-v), and its size is compared with the maximum matching that the
+# exact reference solver (reference.c) finds. A run fails if:
+# - the matcher crashes or takes longer than TIME_BUDGET seconds;
+# - a vertex is matched twice, or a match is not an edge;
+# - an edge has two free vertices, so the matching is not maximal;
+# - the matching is larger than a maximum matching;
+# - the matching is smaller than in the previous run in the history file.
+#
+# Every run is appended to the history file (default: regression-history.csv)
+# with the current commit, so that slowdowns show up over commits. The
+# script exits with status 1 if any run failed.
+MAX_PROCESSES=${MAX_PROCESSES:-$(nproc)}
+TIME_BUDGET=${TIME_BUDGET:-60}
+HISTORY=${HISTORY:-regression-history.csv}
+
+BINARY=$1
+REFERENCE=$2
+GENERATOR=$3
+
+if [ -z "$BINARY" ] || [ -z "$REFERENCE" ] || [ -z "$GENERATOR" ]; then
+    echo "Usage: $0 <binary> <reference> <generator>" >&2
+    exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+COMMIT=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+DATE=$(date +%Y-%m-%dT%H:%M:%S)
+FAILURES=0
+
+if [ ! -f "$HISTORY" ]; then
+    echo "commit,date,graph,processes,matches,maximum,seconds" > "$HISTORY"
+fi
+
+# Small graphs of every family, each of which stresses the matcher
+# differently.
+"$GENERATOR" -s 1 -r er 1000 3000           > "$WORK/er.input"
+"$GENERATOR" -s 2 -r rmat 10 8              > "$WORK/rmat.input"
+"$GENERATOR" -s 3 -r grid2d 30 30           > "$WORK/grid2d.input"
+"$GENERATOR" -s 4 -r grid3d 10 10 10        > "$WORK/grid3d.input"
+"$GENERATOR" -s 5 -r path 1001              > "$WORK/path.input"
+"$GENERATOR" -s 6 -r cycle 1000             > "$WORK/cycle.input"
+"$GENERATOR" -s 7 -r tree 1000              > "$WORK/tree.input"
+"$GENERATOR" -s 8 -r bipartite 400 600 2500 > "$WORK/bipartite.input"
+
+# Every graph above has fewer vertices than SMALL_COMPONENT_SIZE, so it is
+# matched on a single process. These graphs are large enough to go through
+# the distributed supersteps.
+"$GENERATOR" -s 11 -r er 20000 60000             > "$WORK/er-large.input"
+"$GENERATOR" -s 12 -r rmat 15 8                  > "$WORK/rmat-large.input"
+"$GENERATOR" -s 13 -r grid2d 150 150             > "$WORK/grid2d-large.input"
+"$GENERATOR" -s 14 -r grid3d 25 25 25            > "$WORK/grid3d-large.input"
+"$GENERATOR" -s 15 -r path 20001                 > "$WORK/path-large.input"
+"$GENERATOR" -s 16 -r cycle 20000                > "$WORK/cycle-large.input"
+"$GENERATOR" -s 17 -r tree 20000                 > "$WORK/tree-large.input"
+"$GENERATOR" -s 18 -r bipartite 8000 12000 50000 > "$WORK/bipartite-large.input"
+
+# 1, 2, 4, ... processes, and the largest amount.
+PROCESS_COUNTS=""
+P=1
+while [ "$P" -lt "$MAX_PROCESSES" ]; do
+    PROCESS_COUNTS="$PROCESS_COUNTS $P"
+    P=$((P * 2))
+done
+PROCESS_COUNTS="$PROCESS_COUNTS $MAX_PROCESSES"
+
+for GRAPH in testcases/*.input "$WORK"/*.input; do
+    NAME=$(basename "$GRAPH" .input)
+    MAXIMUM=$("$REFERENCE" < "$GRAPH" | sed -n "s/^Maximum matching of \([0-9]*\) edges.$/\1/p")
+
+    for P in $PROCESS_COUNTS; do
+        timeout "$TIME_BUDGET" "$BINARY" -p "$P" -v < "$GRAPH" > "$WORK/output.txt" 2>&1
+        STATUS=$?
+
+        MATCHES=$(sed -n "s/^Found a matching of \([0-9]*\) edges.*/\1/p" "$WORK/output.txt")
+        DURATION=$(sed -n "s/^Found a matching of .* in \([0-9.]*\) seconds.$/\1/p" "$WORK/output.txt")
+        ERRORS=$(sed -n "s/^Validated .*: \([0-9]*\) vertices in several matches, \([0-9]*\) matches that are not edges.*/\1 \2/p" "$WORK/output.txt")
+        FREE_EDGES=$(sed -n "s/^Validated .*, \([0-9]*\) edges with two free vertices.$/\1/p" "$WORK/output.txt")
+
+        # The last run of this graph with these processes on another commit.
+        PREVIOUS=$(awk -F, -v g="$NAME" -v p="$P" -v c="$COMMIT" \
+            '$3 == g && $4 == p && $1 != c { last = $5 " " $7 } END { print last }' "$HISTORY")
+        PREVIOUS_MATCHES=${PREVIOUS% *}
+        PREVIOUS_SECONDS=${PREVIOUS#* }
+
+        if [ "$STATUS" -eq 124 ]; then
+            RESULT="FAIL (over the budget of $TIME_BUDGET s)"
+        elif [ "$STATUS" -ne 0 ] || [ -z "$MATCHES" ] || [ -z "$ERRORS" ] ||
+             [ -z "$FREE_EDGES" ]; then
+            RESULT="FAIL (exit status $STATUS)"
+        elif [ "$ERRORS" != "0 0" ]; then
+            RESULT="FAIL (invalid matching)"
+        elif [ "$FREE_EDGES" -ne 0 ]; then
+            RESULT="FAIL (not maximal, $FREE_EDGES free edges)"
+        elif [ "$MATCHES" -gt "$MAXIMUM" ]; then
+            RESULT="FAIL (larger than maximum)"
+        elif [ -n "$PREVIOUS" ] && [ "$MATCHES" -lt "$PREVIOUS_MATCHES" ]; then
+            RESULT="FAIL (was $PREVIOUS_MATCHES edges)"
+        else
+            RESULT="PASS"
+        fi
+
+        case $RESULT in
+            FAIL*) FAILURES=$((FAILURES + 1)) ;;
+        esac
+
+        if [ -n "$PREVIOUS" ]; then
+            HISTORY_NOTE="(was $PREVIOUS_SECONDS s)"
+        else
+            HISTORY_NOTE=""
+        fi
+
+        printf "%-12s p=%-3u %6s / %-6s edges %10s s %s %s\n" "$NAME" "$P" \
+            "${MATCHES:--}" "$MAXIMUM" "${DURATION:--}" "$HISTORY_NOTE" "$RESULT"
+
+        if [ -n "$MATCHES" ]; then
+            echo "$COMMIT,$DATE,$NAME,$P,$MATCHES,$MAXIMUM,$DURATION" >> "$HISTORY"
+        fi
+    done
+done
+
+if [ "$FAILURES" -gt 0 ]; then
+    echo "$FAILURES runs failed."
+    exit 1
+fi
+echo "All runs passed."
@@ -0,0 +1,151 @@
+#!/bin/sh
+# Measure how the BSP backend scales with the amount of processes.
+#
+# Usage: ./scaling.sh <binary> <generator> [csv file]
+#
+# Every graph family and size is generated once with the generator that
+# generate.c builds, and matched with every amount of processes and every
+# divide strategy. The runs are written to a CSV file (default: scaling.csv)
+# with the duration of each phase, the amount of supersteps, the matching
+# size and the peak memory. Afterwards, strong-scaling and weak-scaling
+# tables with the speedup and efficiency are printed.
+#
+# - Strong scaling matches the same graph of SIZES vertices with every amount
+#   of processes.
+# - Weak scaling matches a graph of SIZES vertices per process.
+#
+# The matrix can be changed with these environment variables:
+PROCESSES=${PROCESSES:-"1 2 4 8"}
+FAMILIES=${FAMILIES:-"er rmat grid2d grid3d path cycle tree bipartite"}
+SIZES=${SIZES:-"100000"}
+DIVIDES=${DIVIDES:-"block cyclic"}
+SEED=${SEED:-1}
+
+BINARY=$1
+GENERATOR=$2
+CSV=${3:-scaling.csv}
+
+if [ -z "$BINARY" ] || [ -z "$GENERATOR" ]; then
+    echo "Usage: $0 <binary> <generator> [csv file]" >&2
+    exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Write a graph of a family with about $2 vertices to the file $3.
+generate() {
+    case $1 in
+        er)        set -- "$1" "$2" "$3" er "$2" $(($2 * 4)) ;;
+        rmat)      set -- "$1" "$2" "$3" rmat $(awk "BEGIN { print int(log($2) / log(2)) }") 8 ;;
+        grid2d)    S=$(awk "BEGIN { print int(sqrt($2)) }")
+                   set -- "$1" "$2" "$3" grid2d "$S" "$S" ;;
+        grid3d)    S=$(awk "BEGIN { print int(exp(log($2) / 3) + 0.5) }")
+                   set -- "$1" "$2" "$3" grid3d "$S" "$S" "$S" ;;
+        bipartite) set -- "$1" "$2" "$3" bipartite $(($2 / 2)) $(($2 - $2 / 2)) $(($2 * 4)) ;;
+        *)         set -- "$1" "$2" "$3" "$1" "$2" ;;
+    esac
+
+    GRAPH=$3
+    shift 3
+    "$GENERATOR" -s "$SEED" -r "$@" > "$GRAPH"
+}
+
+# Match the graph $1 with $2 processes and divide strategy $3, and print the
+# CSV columns of the run.
+measure() {
+    "$BINARY" -p "$2" -d "$3" -s "$WORK/stats.csv" -j "$WORK/timeline.json" \
+        < "$1" > "$WORK/output.txt" || return 1
+
+    # The time of a phase is that of its slowest process.
+    PHASES=$(awk '
+        /"ph": "X"/ {
+            match($0, /"name": "[a-z_]*"/); name = substr($0, RSTART + 9, RLENGTH - 10)
+            match($0, /"tid": [0-9]*/);     tid  = substr($0, RSTART + 7, RLENGTH - 7)
+            match($0, /"dur": [0-9.]*/);    dur  = substr($0, RSTART + 7, RLENGTH - 7)
+            time[name "," tid] += dur / 1e6
+            if (time[name "," tid] > phase[name]) phase[name] = time[name "," tid]
+        }
+        END {
+            printf "%.6f,%.6f,%.6f,%.6f,%.6f", phase["load_structure"],
+                   phase["solve_small_components"], phase["remove_singletons"],
+                   phase["send_instructions"], phase["interpret_instructions"]
+        }' "$WORK/timeline.json")
+
+    # Every value is found by its own line, whatever order they come in.
+    MATCHES=$(sed -n "s/^Found a matching of \([0-9]*\) edges in .*/\1/p" "$WORK/output.txt")
+    DURATION=$(sed -n "s/^Found a matching of .* in \([0-9.]*\) seconds.$/\1/p" "$WORK/output.txt")
+    SUPERSTEPS=$(sed -n "s/^BSP cost of \([0-9]*\) supersteps.*/\1/p" "$WORK/output.txt")
+    PEAK=$(sed -n "s/^Peak memory of \([0-9]*\) KiB.$/\1/p" "$WORK/output.txt")
+
+    echo "$DURATION,$PHASES,$SUPERSTEPS,$MATCHES,$PEAK"
+}
+
+echo "scaling,family,size,vertices,edges,divide,processes,seconds,load,components,singletons,send,interpret,supersteps,matches,peak_kib" > "$CSV"
+
+for FAMILY in $FAMILIES; do
+    for SIZE in $SIZES; do
+        for P in $PROCESSES; do
+            for SCALING in strong weak; do
+                if [ "$SCALING" = strong ]; then
+                    N=$SIZE
+                else
+                    N=$((SIZE * P))
+                fi
+
+                GRAPH="$WORK/$FAMILY-$N.input"
+                if [ ! -f "$GRAPH" ]; then
+                    generate "$FAMILY" "$N" "$GRAPH"
+                fi
+                read VERTICES EDGES < "$GRAPH"
+
+                for DIVIDE in $DIVIDES; do
+                    if ROW=$(measure "$GRAPH" "$P" "$DIVIDE"); then
+                        echo "$SCALING,$FAMILY,$SIZE,$VERTICES,$EDGES,$DIVIDE,$P,$ROW" >> "$CSV"
+                    else
+                        echo "Run failed: $FAMILY with $N vertices, $P processes, $DIVIDE." >&2
+                    fi
+                done
+            done
+        done
+    done
+done
+
+# Compare every run with the run on the fewest processes of the same series.
+awk -F, '
+    NR == 1 { next }
+    {
+        series = $1 "," $2 "," $3 "," $6
+        if (!(series in base) || $7 < base_p[series]) {
+            base[series] = $8; base_p[series] = $7
+        }
+        row[NR] = $0
+    }
+    END {
+        for (scaling = 1; scaling <= 2; scaling++) {
+            name = scaling == 1 ? "strong" : "weak"
+            printf "\n%s scaling\n", name
+            printf "%-10s %10s %-7s %9s %11s %9s %10s\n", "family", "vertices",
+                   "divide", "processes", "seconds", "speedup", "efficiency"
+
+            for (i = 2; i <= NR; i++) {
+                split(row[i], f, ",")
+                if (f[1] != name) continue
+
+                series  = f[1] "," f[2] "," f[3] "," f[6]
+                speedup = f[8] > 0 ? base[series] / f[8] : 0
+
+                # Weak scaling keeps the work per process the same, so the
+                # ideal time stays the same as well.
+                if (name == "strong") {
+                    speedup    = speedup * base_p[series]
+                    efficiency = speedup / f[7]
+                } else {
+                    efficiency = speedup
+                }
+
+                printf "%-10s %10s %-7s %9s %11.6f %9.2f %10.2f\n", f[2], f[4],
+                       f[6], f[7], f[8], speedup, efficiency
+            }
+        }
+    }' "$CSV"
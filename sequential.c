@@ -0,0 +1,179 @@
+#include "match.h"
+#include "sequential.h"
+#include "utilities.h"
+
+// PRIVATE FUNCTIONS
+void match_sequential_pair(nid_int v, nid_int u, nid_int *ids, 
+                           nid_int *offsets, nid_int *targets, 
+                           nid_int *degree, bool *matched, 
+                           nid_int *queue, nid_int *queue_length,
+                           struct matching *m);
+
+/**
+ * Find a maximal matching in a graph without any communication.
+ *
+ * The matching is built with the Karp-Sipser heuristic: vertices of degree 1
+ * are matched to their only neighbour first, and an arbitrary edge is only
+ * chosen when no such vertex remains.
+ *
+ * Parameters:
+ * - `edges`        Array of edges between arbitrary node identifiers.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `m`            Matching structure that stores the new matches.
+ */
+void match_sequential(nid_int (*edges)[2], nid_int edges_length,
+                      struct matching *m) {
+    // Give every endpoint a compact index.
+    nid_int *ids        = malloc(2 * edges_length * sizeof(nid_int));
+    nid_int  ids_length = 0;
+
+    for (nid_int i=0; i<edges_length; i++) {
+        ids[2*i]   = edges[i][0];
+        ids[2*i+1] = edges[i][1];
+    }
+    qsort(ids, 2 * edges_length, sizeof(nid_int), compare_nids);
+
+    for (nid_int i=0; i<2*edges_length; i++) {
+        if (ids_length == 0 || ids[ids_length-1] != ids[i]) {
+            ids[ids_length] = ids[i];
+            ids_length++;
+        }
+    }
+
+    // Build the adjacency arrays.
+    nid_int *offsets = calloc(ids_length + 1, sizeof(nid_int));
+    nid_int *targets = malloc(2 * edges_length * sizeof(nid_int));
+    nid_int *degree  = calloc(ids_length + 1, sizeof(nid_int));
+    bool    *matched = calloc(ids_length + 1, sizeof(bool));
+    nid_int *queue   = malloc((ids_length + 1) * sizeof(nid_int));
+    nid_int  queue_length = 0;
+
+    for (nid_int i=0; i<edges_length; i++) {
+        if (edges[i][0] != edges[i][1]) {   // Loops never match.
+            degree[search_sorted(ids, ids_length, edges[i][0])]++;
+            degree[search_sorted(ids, ids_length, edges[i][1])]++;
+        }
+    }
+    for (nid_int v=0; v<ids_length; v++) {
+        offsets[v+1] = offsets[v] + degree[v];
+        degree[v]    = 0;
+    }
+    for (nid_int i=0; i<edges_length; i++) {
+        if (edges[i][0] != edges[i][1]) {
+            nid_int a = search_sorted(ids, ids_length, edges[i][0]);
+            nid_int b = search_sorted(ids, ids_length, edges[i][1]);
+
+            targets[offsets[a] + degree[a]] = b;
+            degree[a]++;
+            targets[offsets[b] + degree[b]] = a;
+            degree[b]++;
+        }
+    }
+
+    for (nid_int v=0; v<ids_length; v++) {
+        if (degree[v] == 1) {
+            queue[queue_length] = v;
+            queue_length++;
+        }
+    }
+
+    reserve_matching(m, ids_length / 2);
+
+    // Match vertices of degree 1 first. Only pick an arbitrary edge when
+    // none are left.
+    nid_int next = 0;
+
+    while (true) {
+        nid_int v;
+
+        if (queue_length > 0) {
+            queue_length--;
+            v = queue[queue_length];
+        } else {
+            while (next < ids_length && (matched[next] || degree[next] == 0)) {
+                next++;
+            }
+            if (next == ids_length) {
+                break;
+            }
+            v = next;
+        }
+
+        if (matched[v] || degree[v] == 0) {
+            continue;
+        }
+
+        for (nid_int i=offsets[v]; i<offsets[v+1]; i++) {
+            if (!matched[targets[i]]) {
+                match_sequential_pair(v, targets[i], ids, offsets, targets,
+                                      degree, matched, queue, &queue_length,
+                                      m);
+                break;
+            }
+        }
+    }
+
+    free(ids);
+    free(offsets);
+    free(targets);
+    free(degree);
+    free(matched);
+    free(queue);
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Match two vertices and update the degrees of their unmatched neighbours.
+ *
+ * Neighbours that are left with degree 1 are added to the queue.
+ *
+ * Parameters:
+ * - `v`            Compact index of the first vertex.
+ * - `u`            Compact index of the second vertex.
+ * - `ids`          Original node identifiers of each compact index.
+ * - `offsets`      Start of each vertex' neighbours in `targets`.
+ * - `targets`      Compact indices of all neighbours.
+ * - `degree`       Amount of unmatched neighbours of each vertex.
+ * - `matched`      Whether each vertex has been matched already.
+ * - `queue`        Queue of vertices of degree 1.
+ * - `queue_length` Array length of parameter `queue`.
+ * - `m`            Matching structure that stores the new match.
+ */
+void match_sequential_pair(nid_int v, nid_int u, nid_int *ids, 
+                           nid_int *offsets, nid_int *targets, 
+                           nid_int *degree, bool *matched, 
+                           nid_int *queue, nid_int *queue_length,
+                           struct matching *m) {
+    matched[v] = true;
+    matched[u] = true;
+    insert_match(m, ids[v], ids[u]);
+
+    nid_int pair[2] = {v, u};
+
+    for (unsigned short int j=0; j<2; j++) {
+        nid_int x = pair[j];
+
+        for (nid_int i=offsets[x]; i<offsets[x+1]; i++) {
+            nid_int w = targets[i];
+
+            if (!matched[w]) {
+                degree[w]--;
+
+                if (degree[w] == 1) {
+                    queue[*queue_length] = w;
+                    (*queue_length)++;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,15 @@
+
+/**
+ * Find a maximal matching in a graph without any communication.
+ *
+ * The matching is built with the Karp-Sipser heuristic: vertices of degree 1
+ * are matched to their only neighbour first, and an arbitrary edge is only
+ * chosen when no such vertex remains.
+ *
+ * Parameters:
+ * - `edges`        Array of edges between arbitrary node identifiers.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `m`            Matching structure that stores the new matches.
+ */
+void match_sequential(nid_int (*edges)[2], nid_int edges_length,
+                      struct matching *m);
@@ -0,0 +1,532 @@
+#include "shared.h"
+#include "utilities.h"
+
+// The amount of vertices that a thread takes from a cursor at once.
+#define SHARED_CHUNK_SIZE 256
+
+// Result of a steal that lost a race with another thread.
+#define DEQUE_ABORT ((nid_int) -2)
+
+// PRIVATE FUNCTIONS
+bool claim_pair(struct shared_matching *sm, nid_int v, nid_int u);
+void create_deque(struct deque *d);
+nid_int deque_steal(struct deque *d);
+void deque_push(struct deque *d, nid_int v);
+nid_int deque_take(struct deque *d);
+bool is_free(struct shared_matching *sm, nid_int v);
+void match_free_vertex(struct shared_matching *sm, nid_int v, uint t);
+bool run_shared_task(struct shared_matching *sm, uint t, uint threads);
+void seed_deques(struct shared_matching *sm, uint t, uint threads);
+void unallocate_deque(struct deque *d);
+
+/**
+ * Create a shared graph structure in CSR format from an array of edges.
+ *
+ * Loops are left out, as a vertex can never match with itself.
+ *
+ * Parameters:
+ * - `total_nodes`  The total amount of nodes in the graph.
+ * - `edges`        Array of edges.
+ * - `total_edges`  Array length of parameter `edges`.
+ *
+ * Returns:         Pointer to a newly created CSR graph structure.
+ */
+struct csr_graph *create_csr_graph(nid_int total_nodes, nid_int (*edges)[2],
+                                   nid_int total_edges) {
+    struct csr_graph *csr = malloc(sizeof(struct csr_graph));
+    nid_int *fill         = calloc(total_nodes + 1, sizeof(nid_int));
+
+    csr->nodes   = total_nodes;
+    csr->offsets = calloc(total_nodes + 1, sizeof(nid_int));
+
+    // Count the degree of every vertex.
+    OMP(omp parallel for)
+    for (nid_int i=0; i<total_edges; i++) {
+        if (edges[i][0] != edges[i][1]) {
+            OMP(omp atomic)
+            csr->offsets[edges[i][0] + 1]++;
+            OMP(omp atomic)
+            csr->offsets[edges[i][1] + 1]++;
+        }
+    }
+
+    for (nid_int v=0; v<total_nodes; v++) {
+        csr->offsets[v+1] = csr->offsets[v+1] + csr->offsets[v];
+    }
+
+    csr->targets = malloc((csr->offsets[total_nodes] + 1) * sizeof(nid_int));
+
+    // Insert the neighbours.
+    OMP(omp parallel for)
+    for (nid_int i=0; i<total_edges; i++) {
+        if (edges[i][0] != edges[i][1]) {
+            for (unsigned short int j=0; j<2; j++) {
+                nid_int node = edges[i][j];
+                nid_int size;
+
+                OMP(omp atomic capture)
+                size = fill[node]++;
+
+                csr->targets[csr->offsets[node] + size] = edges[i][1-j];
+            }
+        }
+    }
+
+    free(fill);
+    return csr;
+}
+
+/**
+ * Find a maximal matching with all threads of a single machine.
+ *
+ * Threads match vertices of degree 1 first and vertices of degree 2 second.
+ * Each thread keeps its own work-stealing deques of such vertices, and
+ * steals from other threads when it runs out. When no such vertices are left,
+ * a thread matches any vertex to its neighbour of the lowest degree.
+ * All deques are seeded before any thread starts matching, so that the first
+ * picks see every vertex of degree 1 and 2 of the whole graph. After that,
+ * vertices are claimed with compare-and-swap, so no locks or barriers are
+ * needed.
+ *
+ * Parameters:
+ * - `csr`      Shared graph structure.
+ * - `mate`     Array of length `csr->nodes` that will store the mate of every
+ *              vertex, or `NO_MATE` if the vertex remains unmatched.
+ *
+ * Returns:     The amount of matches.
+ */
+nid_int match_shared(const struct csr_graph *csr, nid_int *mate) {
+    uint threads = max_thread_count();
+    nid_int n    = csr->nodes;
+
+    struct shared_matching sm;
+    sm.csr     = csr;
+    sm.mate    = malloc((n + 1) * sizeof(_Atomic nid_int));
+    sm.degree  = malloc((n + 1) * sizeof(_Atomic long));
+    sm.singles = malloc(threads * sizeof(struct deque));
+    sm.doubles = malloc(threads * sizeof(struct deque));
+    atomic_init(&(sm.match_cursor), 0);
+
+    OMP(omp parallel for)
+    for (nid_int v=0; v<n; v++) {
+        atomic_init(&(sm.mate[v]),   NO_MATE);
+        atomic_init(&(sm.degree[v]), csr->offsets[v+1] - csr->offsets[v]);
+    }
+
+    for (uint t=0; t<threads; t++) {
+        create_deque(&(sm.singles[t]));
+        create_deque(&(sm.doubles[t]));
+    }
+
+    // Every thread seeds its deques, and then keeps working until it can't
+    // find any work anywhere.
+    OMP(omp parallel)
+    {
+        uint t       = thread_id();
+        uint threads = thread_count();
+
+        seed_deques(&sm, t, threads);
+
+        OMP(omp barrier)
+
+        while (run_shared_task(&sm, t, threads));
+    }
+
+    nid_int matches = 0;
+
+    for (nid_int v=0; v<n; v++) {
+        nid_int u = atomic_load(&(sm.mate[v]));
+
+        if (u != NO_MATE && atomic_load(&(sm.mate[u])) == v) {
+            mate[v] = u;
+            matches = matches + (v < u);
+        } else {
+            mate[v] = NO_MATE;
+        }
+    }
+
+    for (uint t=0; t<threads; t++) {
+        unallocate_deque(&(sm.singles[t]));
+        unallocate_deque(&(sm.doubles[t]));
+    }
+    free(sm.singles);
+    free(sm.doubles);
+    free(sm.mate);
+    free(sm.degree);
+
+    return matches;
+}
+
+/**
+ * Erase the CSR graph structure from memory.
+ *
+ * Parameters:
+ * - `csr`      The CSR graph structure that is to be freed from memory.
+ */
+void unallocate_csr_graph(struct csr_graph *csr) {
+    free(csr->offsets);
+    free(csr->targets);
+    free(csr);
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Try to match two free vertices.
+ *
+ * The vertex with the lowest identifier is claimed first. If the other vertex
+ * can't be claimed, the first claim is released again.
+ *
+ * Parameters:
+ * - `sm`       Shared matching state.
+ * - `v`        Unique node identifier.
+ * - `u`        Unique node identifier.
+ *
+ * Returns:     boolean whether the vertices were matched.
+ */
+bool claim_pair(struct shared_matching *sm, nid_int v, nid_int u) {
+    nid_int first  = (v < u) ? v : u;
+    nid_int second = (v < u) ? u : v;
+    nid_int free_mate = NO_MATE;
+
+    if (!atomic_compare_exchange_strong(&(sm->mate[first]), &free_mate, 
+                                        second)) {
+        return false;
+    }
+
+    free_mate = NO_MATE;
+    if (!atomic_compare_exchange_strong(&(sm->mate[second]), &free_mate, 
+                                        first)) {
+        atomic_store(&(sm->mate[first]), NO_MATE);
+        return false;
+    }
+
+    return true;
+}
+
+/** PRIVATE
+ * Initialize an empty work-stealing deque.
+ *
+ * Parameters:
+ * - `d`        Deque structure.
+ */
+void create_deque(struct deque *d) {
+    struct deque_array *a = malloc(sizeof(struct deque_array) + 
+                                   SHARED_CHUNK_SIZE * sizeof(_Atomic nid_int));
+    a->size     = SHARED_CHUNK_SIZE;
+    a->previous = NULL;
+
+    atomic_init(&(d->top),    0);
+    atomic_init(&(d->bottom), 0);
+    atomic_init(&(d->array),  a);
+}
+
+/** PRIVATE
+ * Steal the oldest vertex from another thread's deque.
+ *
+ * Parameters:
+ * - `d`        Deque structure.
+ *
+ * Returns:     The stolen vertex, `NO_MATE` if the deque is empty, or
+ *              `DEQUE_ABORT` if another thread took the vertex first.
+ */
+nid_int deque_steal(struct deque *d) {
+    long t = atomic_load_explicit(&(d->top), memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&(d->bottom), memory_order_acquire);
+
+    if (t >= b) {
+        return NO_MATE;
+    }
+
+    struct deque_array *a = atomic_load_explicit(&(d->array), 
+                                                 memory_order_acquire);
+    nid_int v = atomic_load_explicit(&(a->buffer[t % a->size]), 
+                                     memory_order_relaxed);
+
+    if (!atomic_compare_exchange_strong_explicit(&(d->top), &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return DEQUE_ABORT;
+    }
+
+    return v;
+}
+
+/** PRIVATE
+ * Push a vertex to the bottom of the thread's own deque.
+ *
+ * The array of the deque doubles in size when it is full.
+ *
+ * Parameters:
+ * - `d`        Deque structure.
+ * - `v`        Unique node identifier.
+ */
+void deque_push(struct deque *d, nid_int v) {
+    long b = atomic_load_explicit(&(d->bottom), memory_order_relaxed);
+    long t = atomic_load_explicit(&(d->top),    memory_order_acquire);
+    struct deque_array *a = atomic_load_explicit(&(d->array), 
+                                                 memory_order_relaxed);
+
+    if (b - t > a->size - 1) {
+        struct deque_array *bigger = malloc(
+            sizeof(struct deque_array) + 2 * a->size * sizeof(_Atomic nid_int)
+        );
+        bigger->size     = 2 * a->size;
+        bigger->previous = a;
+
+        for (long i=t; i<b; i++) {
+            atomic_store_explicit(
+                &(bigger->buffer[i % bigger->size]),
+                atomic_load_explicit(&(a->buffer[i % a->size]), 
+                                     memory_order_relaxed),
+                memory_order_relaxed
+            );
+        }
+
+        atomic_store_explicit(&(d->array), bigger, memory_order_release);
+        a = bigger;
+    }
+
+    atomic_store_explicit(&(a->buffer[b % a->size]), v, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&(d->bottom), b + 1, memory_order_relaxed);
+}
+
+/** PRIVATE
+ * Take the newest vertex from the thread's own deque.
+ *
+ * Parameters:
+ * - `d`        Deque structure.
+ *
+ * Returns:     The vertex, or `NO_MATE` if the deque is empty.
+ */
+nid_int deque_take(struct deque *d) {
+    long b = atomic_load_explicit(&(d->bottom), memory_order_relaxed) - 1;
+    struct deque_array *a = atomic_load_explicit(&(d->array), 
+                                                 memory_order_relaxed);
+    atomic_store_explicit(&(d->bottom), b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&(d->top), memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&(d->bottom), b + 1, memory_order_relaxed);
+        return NO_MATE;
+    }
+
+    nid_int v = atomic_load_explicit(&(a->buffer[b % a->size]), 
+                                     memory_order_relaxed);
+
+    if (t == b) {
+        // This is the last vertex, so a thief may be racing for it.
+        if (!atomic_compare_exchange_strong_explicit(&(d->top), &t, t + 1,
+                                                     memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            v = NO_MATE;
+        }
+        atomic_store_explicit(&(d->bottom), b + 1, memory_order_relaxed);
+    }
+
+    return v;
+}
+
+/** PRIVATE
+ * Check whether a vertex is still free to match.
+ *
+ * A vertex that is claimed but whose mate doesn't point back yet is in the
+ * middle of being matched. The function waits until that claim is either
+ * finished or released.
+ *
+ * Parameters:
+ * - `sm`       Shared matching state.
+ * - `v`        Unique node identifier.
+ *
+ * Returns:     boolean whether the vertex is unmatched.
+ */
+bool is_free(struct shared_matching *sm, nid_int v) {
+    while (true) {
+        nid_int u = atomic_load(&(sm->mate[v]));
+
+        if (u == NO_MATE) {
+            return true;
+        }
+        if (atomic_load(&(sm->mate[u])) == v) {
+            return false;
+        }
+    }
+}
+
+/** PRIVATE
+ * Match a vertex to its free neighbour of the lowest degree, if it is free.
+ *
+ * After a match, the degrees of all neighbours are lowered. Neighbours that
+ * are left with degree 1 or 2 are pushed to the thread's deques.
+ *
+ * Parameters:
+ * - `sm`       Shared matching state.
+ * - `v`        Unique node identifier.
+ * - `t`        Number of the current thread.
+ */
+void match_free_vertex(struct shared_matching *sm, nid_int v, uint t) {
+    const struct csr_graph *csr = sm->csr;
+
+    while (is_free(sm, v)) {
+        nid_int u      = NO_MATE;
+        long    lowest = 0;
+
+        for (nid_int i=csr->offsets[v]; i<csr->offsets[v+1]; i++) {
+            nid_int w = csr->targets[i];
+            long    d = atomic_load_explicit(&(sm->degree[w]), 
+                                             memory_order_relaxed);
+
+            if ((u == NO_MATE || d < lowest) && is_free(sm, w)) {
+                u      = w;
+                lowest = d;
+            }
+        }
+
+        if (u == NO_MATE) {     // Every neighbour has been matched already.
+            return;
+        }
+
+        if (claim_pair(sm, v, u)) {
+            nid_int pair[2] = {v, u};
+
+            for (unsigned short int j=0; j<2; j++) {
+                nid_int x = pair[j];
+
+                for (nid_int i=csr->offsets[x]; i<csr->offsets[x+1]; i++) {
+                    nid_int w = csr->targets[i];
+
+                    if (atomic_load(&(sm->mate[w])) != NO_MATE) {
+                        continue;
+                    }
+
+                    long d = atomic_fetch_sub(&(sm->degree[w]), 1) - 1;
+
+                    if (d == 1) {
+                        deque_push(&(sm->singles[t]), w);
+                    } else if (d == 2) {
+                        deque_push(&(sm->doubles[t]), w);
+                    }
+                }
+            }
+            return;
+        }
+    }
+}
+
+/** PRIVATE
+ * Find one piece of work and do it.
+ *
+ * Work is picked in the following order:
+ * 1. A vertex of degree 1 of this thread, or stolen from another thread.
+ * 2. A vertex of degree 2 of this thread, or stolen from another thread.
+ * 3. A chunk of vertices that hasn't been matched yet.
+ *
+ * Parameters:
+ * - `sm`       Shared matching state.
+ * - `t`        Number of the current thread.
+ * - `threads`  Amount of threads that are working.
+ *
+ * Returns:     boolean whether any work may be left.
+ */
+bool run_shared_task(struct shared_matching *sm, uint t, uint threads) {
+    struct deque *lists[2] = {sm->singles, sm->doubles};
+    bool aborted = false;
+    nid_int n    = sm->csr->nodes;
+
+    for (unsigned short int j=0; j<2; j++) {
+        nid_int v = deque_take(&(lists[j][t]));
+
+        for (uint i=1; i<threads && v == NO_MATE; i++) {
+            v = deque_steal(&(lists[j][(t + i) % threads]));
+
+            if (v == DEQUE_ABORT) {
+                aborted = true;
+                v       = NO_MATE;
+            }
+        }
+
+        if (v != NO_MATE) {
+            match_free_vertex(sm, v, t);
+            return true;
+        }
+    }
+
+    nid_int start = n;
+
+    // Only move the cursor while it points inside the graph, 
+    // so it can't overflow.
+    if (atomic_load(&(sm->match_cursor)) < n) {
+        start = atomic_fetch_add(&(sm->match_cursor), SHARED_CHUNK_SIZE);
+    }
+
+    if (start < n) {
+        nid_int end = (n - start < SHARED_CHUNK_SIZE) ? n : start + SHARED_CHUNK_SIZE;
+
+        for (nid_int v=start; v<end; v++) {
+            match_free_vertex(sm, v, t);
+
+            // Vertices of degree 1 that appeared go first.
+            for (nid_int w=deque_take(&(sm->singles[t])); w != NO_MATE;
+                         w=deque_take(&(sm->singles[t]))) {
+                match_free_vertex(sm, w, t);
+            }
+        }
+        return true;
+    }
+
+    return aborted;
+}
+
+/** PRIVATE
+ * Push the vertices of degree 1 and 2 of the thread's block of the graph to
+ * its deques.
+ *
+ * Parameters:
+ * - `sm`       Shared matching state.
+ * - `t`        Number of the current thread.
+ * - `threads`  Amount of threads that are working.
+ */
+void seed_deques(struct shared_matching *sm, uint t, uint threads) {
+    nid_int n = sm->csr->nodes;
+
+    nid_int start = (unsigned long long) n * t       / threads;
+    nid_int end   = (unsigned long long) n * (t + 1) / threads;
+
+    for (nid_int v=start; v<end; v++) {
+        long d = atomic_load(&(sm->degree[v]));
+
+        if (d == 1) {
+            deque_push(&(sm->singles[t]), v);
+        } else if (d == 2) {
+            deque_push(&(sm->doubles[t]), v);
+        }
+    }
+}
+
+/** PRIVATE
+ * Erase the arrays of a deque from memory.
+ *
+ * Parameters:
+ * - `d`        Deque structure.
+ */
+void unallocate_deque(struct deque *d) {
+    struct deque_array *a = atomic_load(&(d->array));
+
+    while (a != NULL) {
+        struct deque_array *previous = a->previous;
+        free(a);
+        a = previous;
+    }
+}
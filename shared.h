@@ -0,0 +1,44 @@
+
+/**
+ * Create a shared graph structure in CSR format from an array of edges.
+ *
+ * Loops are left out, as a vertex can never match with itself.
+ *
+ * Parameters:
+ * - `total_nodes`  The total amount of nodes in the graph.
+ * - `edges`        Array of edges.
+ * - `total_edges`  Array length of parameter `edges`.
+ *
+ * Returns:         Pointer to a newly created CSR graph structure.
+ */
+struct csr_graph *create_csr_graph(nid_int total_nodes, nid_int (*edges)[2],
+                                   nid_int total_edges);
+
+/**
+ * Find a maximal matching with all threads of a single machine.
+ *
+ * Threads match vertices of degree 1 first and vertices of degree 2 second.
+ * Each thread keeps its own work-stealing deques of such vertices, and
+ * steals from other threads when it runs out. When no such vertices are left,
+ * a thread matches any vertex to its neighbour of the lowest degree.
+ * All deques are seeded before any thread starts matching, so that the first
+ * picks see every vertex of degree 1 and 2 of the whole graph. After that,
+ * vertices are claimed with compare-and-swap, so no locks or barriers are
+ * needed.
+ *
+ * Parameters:
+ * - `csr`      Shared graph structure.
+ * - `mate`     Array of length `csr->nodes` that will store the mate of every
+ *              vertex, or `NO_MATE` if the vertex remains unmatched.
+ *
+ * Returns:     The amount of matches.
+ */
+nid_int match_shared(const struct csr_graph *csr, nid_int *mate);
+
+/**
+ * Erase the CSR graph structure from memory.
+ *
+ * Parameters:
+ * - `csr`      The CSR graph structure that is to be freed from memory.
+ */
+void unallocate_csr_graph(struct csr_graph *csr);
@@ -0,0 +1,422 @@
+#include "stats.h"
+
+// The amount of values per superstep that every process reports to PID 0.
+#define STATS_FIELDS 8
+
+// BSP processes may be threads of the same program, 
+// so every process keeps its own measurements.
+static _Thread_local struct stats *STATS = NULL;
+
+// PRIVATE FUNCTIONS
+void start_superstep(struct stats *s);
+void print_stats(double *rows, nid_int supersteps, double g, double l);
+void print_worst_supersteps(double *rows, nid_int supersteps, double g, 
+                            double l);
+void write_stats(const char *csv_path, double *rows, nid_int supersteps);
+
+/**
+ * Start measuring the supersteps of this process.
+ *
+ * Before this function is called, synchronisations and communication are
+ * not recorded.
+ */
+void start_stats(void) {
+    STATS = malloc(sizeof(struct stats));
+
+    STATS->length     = 0;
+    STATS->max_length = 64;
+    STATS->supersteps = malloc(STATS->max_length * 
+                               sizeof(struct superstep_stats));
+    STATS->last_sync  = bsp_time();
+
+    start_superstep(STATS);
+}
+
+/**
+ * Put data in the memory of another process, and record the communication.
+ *
+ * The parameters are the same as those of `bsp_put`.
+ */
+void counted_put(uint pid, const void *src, void *dst, size_t offset, 
+                 size_t nbytes) {
+    bsp_put(pid, src, dst, offset, nbytes);
+
+    if (STATS != NULL) {
+        struct superstep_stats *current = &(STATS->supersteps[STATS->length]);
+
+        current->messages_to[pid]++;
+        current->bytes_to[pid] = current->bytes_to[pid] + nbytes;
+    }
+}
+
+/**
+ * Synchronise all processes, and record how long the superstep took.
+ */
+void counted_sync(void) {
+    if (STATS == NULL) {
+        bsp_sync();
+        return;
+    }
+
+    double before = bsp_time();
+    bsp_sync();
+    double after  = bsp_time();
+
+    struct superstep_stats *current = &(STATS->supersteps[STATS->length]);
+    current->compute = before - STATS->last_sync;
+    current->sync    = after  - before;
+
+    STATS->last_sync = after;
+    STATS->length++;
+
+    start_superstep(STATS);
+}
+
+/**
+ * Record how much of the graph was removed in the current superstep.
+ *
+ * Parameters:
+ * - `vertices`     Amount of vertices that were removed.
+ * - `edges`        Amount of edges that were removed with those vertices.
+ */
+void count_removed(nid_int vertices, nid_int edges) {
+    if (STATS != NULL) {
+        struct superstep_stats *current = &(STATS->supersteps[STATS->length]);
+
+        current->vertices_removed = current->vertices_removed + vertices;
+        current->edges_removed    = current->edges_removed    + edges;
+    }
+}
+
+/**
+ * Print a summary of the recorded supersteps, with the BSP cost
+ * w + g*h + l of the run and the imbalance between processes.
+ *
+ * Every process needs to call this function, but only PID 0 prints.
+ *
+ * Parameters:
+ * - `csv_path`     File that will store the measurements of every process in
+ *                  every superstep, or NULL to skip the file.
+ * - `g`            Time in seconds to communicate one byte.
+ * - `l`            Time in seconds of a synchronisation.
+ */
+void report_stats(const char *csv_path, double g, double l) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+    nid_int supersteps = STATS->length;
+
+    // Tell every process how much we sent to it in each superstep.
+    double *sent     = malloc((2 * supersteps + 1) * sizeof(double));
+    double *received = malloc((2 * n * supersteps + 1) * sizeof(double));
+    bsp_push_reg(received, 2 * n * supersteps * sizeof(double));
+    bsp_sync();
+
+    for (uint q=0; q<n; q++) {
+        for (nid_int s=0; s<supersteps; s++) {
+            sent[2*s]   = STATS->supersteps[s].messages_to[q];
+            sent[2*s+1] = STATS->supersteps[s].bytes_to[q];
+        }
+
+        bsp_put(q, sent, received, 2 * p * supersteps * sizeof(double),
+                2 * supersteps * sizeof(double));
+    }
+    bsp_sync();
+    bsp_pop_reg(received);
+
+    // Collect the measurements of this process.
+    double *row  = calloc(STATS_FIELDS * supersteps + 1, sizeof(double));
+    double *rows = malloc((STATS_FIELDS * n * supersteps + 1) * sizeof(double));
+    bsp_push_reg(rows, STATS_FIELDS * n * supersteps * sizeof(double));
+    bsp_sync();
+
+    for (nid_int s=0; s<supersteps; s++) {
+        struct superstep_stats *step = &(STATS->supersteps[s]);
+        double *r = &(row[STATS_FIELDS * s]);
+
+        r[0] = step->compute;
+        r[1] = step->sync;
+        r[6] = step->vertices_removed;
+        r[7] = step->edges_removed;
+
+        for (uint q=0; q<n; q++) {
+            r[2] = r[2] + step->messages_to[q];
+            r[3] = r[3] + step->bytes_to[q];
+            r[4] = r[4] + received[2 * (q * supersteps + s)];
+            r[5] = r[5] + received[2 * (q * supersteps + s) + 1];
+        }
+    }
+
+    bsp_put(0, row, rows, STATS_FIELDS * p * supersteps * sizeof(double),
+            STATS_FIELDS * supersteps * sizeof(double));
+    bsp_sync();
+    bsp_pop_reg(rows);
+
+    if (p == 0) {
+        print_stats(rows, supersteps, g, l);
+
+        if (csv_path != NULL) {
+            write_stats(csv_path, rows, supersteps);
+        }
+    }
+
+    free(sent);
+    free(received);
+    free(row);
+    free(rows);
+}
+
+/**
+ * Read the BSP machine parameters from a file that the probe program wrote.
+ *
+ * Parameters:
+ * - `path`     File to read.
+ * - `g`        Will store the time in seconds to communicate one byte.
+ * - `l`        Will store the time in seconds of a synchronisation.
+ *
+ * Returns:     Whether the file contained both parameters.
+ */
+bool load_bsp_parameters(const char *path, double *g, double *l) {
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    bool found_g = false;
+    bool found_l = false;
+
+    // Lines that start with # are comments.
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "g %lf", g) == 1) {
+            found_g = true;
+        } else if (sscanf(line, "l %lf", l) == 1) {
+            found_l = true;
+        }
+    }
+
+    fclose(file);
+    return found_g && found_l;
+}
+
+/**
+ * Stop measuring and erase the recorded supersteps from memory.
+ */
+void unallocate_stats(void) {
+    if (STATS == NULL) {
+        return;
+    }
+
+    // The current, unfinished superstep has its arrays allocated too.
+    for (nid_int s=0; s<=STATS->length; s++) {
+        free(STATS->supersteps[s].messages_to);
+        free(STATS->supersteps[s].bytes_to);
+    }
+
+    free(STATS->supersteps);
+    free(STATS);
+    STATS = NULL;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Prepare an empty record for the next superstep.
+ *
+ * Parameters:
+ * - `s`        Measurements of this process.
+ */
+void start_superstep(struct stats *s) {
+    uint n = bsp_nprocs();
+
+    if (s->length == s->max_length) {
+        s->max_length = 2 * s->max_length;
+        s->supersteps = realloc(s->supersteps, s->max_length * 
+                                sizeof(struct superstep_stats));
+    }
+
+    struct superstep_stats *step = &(s->supersteps[s->length]);
+
+    step->compute          = 0;
+    step->sync             = 0;
+    step->vertices_removed = 0;
+    step->edges_removed    = 0;
+    step->messages_to      = calloc(n, sizeof(unsigned long long));
+    step->bytes_to         = calloc(n, sizeof(unsigned long long));
+}
+
+/** PRIVATE
+ * Print the BSP cost of the run and the totals of every process.
+ *
+ * Parameters:
+ * - `rows`         Measurements of every process in every superstep.
+ * - `supersteps`   Amount of supersteps.
+ * - `g`            Time in seconds to communicate one byte.
+ * - `l`            Time in seconds of a synchronisation.
+ */
+void print_stats(double *rows, nid_int supersteps, double g, double l) {
+    uint n = bsp_nprocs();
+
+    double work      = 0;   // Sum of the largest computation per superstep
+    double relations = 0;   // Sum of the h-relations in bytes
+    double elapsed   = 0;   // Time of the slowest process
+
+    for (nid_int s=0; s<supersteps; s++) {
+        double w = 0;
+        double h = 0;
+
+        for (uint q=0; q<n; q++) {
+            double *r = &(rows[STATS_FIELDS * (q * supersteps + s)]);
+
+            w = (r[0] > w) ? r[0] : w;
+            h = (r[3] > h) ? r[3] : h;
+            h = (r[5] > h) ? r[5] : h;
+        }
+
+        work      = work + w;
+        relations = relations + h;
+    }
+
+    printf("BSP cost of " NID_FORMAT " supersteps (g = %.3e s/byte, l = %.3e s):\n", 
+           supersteps, g, l);
+    printf("  computation     w = %.6f s\n", work);
+    printf("  communication g*h = %.6f s (h = %.0f bytes)\n", 
+           g * relations, relations);
+    printf("  synchronisation l = %.6f s\n", supersteps * l);
+    printf("  predicted  w+gh+l = %.6f s\n", 
+           work + g * relations + supersteps * l);
+
+    printf("PID   compute (s)    sync (s)  msgs sent  msgs recv  bytes sent  "
+           "bytes recv  vertices     edges\n");
+
+    double most_compute  = 0;
+    double total_compute = 0;
+
+    for (uint q=0; q<n; q++) {
+        double totals[STATS_FIELDS] = {0};
+
+        for (nid_int s=0; s<supersteps; s++) {
+            for (uint f=0; f<STATS_FIELDS; f++) {
+                totals[f] = totals[f] + rows[STATS_FIELDS * (q * supersteps + s) + f];
+            }
+        }
+
+        printf("%3u %13.6f %11.6f %10.0f %10.0f %11.0f %11.0f %9.0f %9.0f\n",
+               q, totals[0], totals[1], totals[2], totals[4], totals[3], 
+               totals[5], totals[6], totals[7]);
+
+        most_compute  = (totals[0] > most_compute) ? totals[0] : most_compute;
+        total_compute = total_compute + totals[0];
+        elapsed = (totals[0] + totals[1] > elapsed) ? 
+                   totals[0] + totals[1] : elapsed;
+    }
+
+    printf("  measured time     = %.6f s\n", elapsed);
+    printf("  imbalance (max / mean computation) = %.3f\n", 
+           total_compute == 0 ? 1.0 : most_compute * n / total_compute);
+
+    print_worst_supersteps(rows, supersteps, g, l);
+}
+
+/** PRIVATE
+ * Print the predicted cost w + g*h + l and the measured cost of the
+ * supersteps that took longest.
+ *
+ * Parameters:
+ * - `rows`         Measurements of every process in every superstep.
+ * - `supersteps`   Amount of supersteps.
+ * - `g`            Time in seconds to communicate one byte.
+ * - `l`            Time in seconds of a synchronisation.
+ */
+void print_worst_supersteps(double *rows, nid_int supersteps, double g, 
+                            double l) {
+    uint n = bsp_nprocs();
+
+    double *predicted = malloc((supersteps + 1) * sizeof(double));
+    double *measured  = malloc((supersteps + 1) * sizeof(double));
+    double *relation  = malloc((supersteps + 1) * sizeof(double));
+
+    for (nid_int s=0; s<supersteps; s++) {
+        double w = 0;
+        double h = 0;
+        double t = 0;
+
+        for (uint q=0; q<n; q++) {
+            double *r = &(rows[STATS_FIELDS * (q * supersteps + s)]);
+
+            w = (r[0] > w) ? r[0] : w;
+            h = (r[3] > h) ? r[3] : h;
+            h = (r[5] > h) ? r[5] : h;
+            t = (r[0] + r[1] > t) ? r[0] + r[1] : t;
+        }
+
+        predicted[s] = w + g * h + l;
+        measured[s]  = t;
+        relation[s]  = h;
+    }
+
+    printf("Longest supersteps:\n");
+    printf("superstep  predicted (s)  measured (s)  h (bytes)\n");
+
+    // Pick the longest remaining superstep, and mark it as printed.
+    for (nid_int i=0; i<STATS_WORST_SUPERSTEPS && i<supersteps; i++) {
+        nid_int worst = 0;
+
+        for (nid_int s=1; s<supersteps; s++) {
+            if (measured[s] > measured[worst]) {
+                worst = s;
+            }
+        }
+
+        // A run never has more than 4 billion supersteps.
+        printf("%9u %14.6f %13.6f %10.0f\n", (uint) worst, 
+               predicted[worst], measured[worst], relation[worst]);
+        measured[worst] = -1;
+    }
+
+    free(predicted);
+    free(measured);
+    free(relation);
+}
+
+/** PRIVATE
+ * Write the measurements of every process in every superstep to a CSV file.
+ *
+ * Parameters:
+ * - `csv_path`     File to write to.
+ * - `rows`         Measurements of every process in every superstep.
+ * - `supersteps`   Amount of supersteps.
+ */
+void write_stats(const char *csv_path, double *rows, nid_int supersteps) {
+    uint n = bsp_nprocs();
+    FILE *file = fopen(csv_path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write the statistics to %s.\n", csv_path);
+        return;
+    }
+
+    fprintf(file, "superstep,pid,compute,sync,messages_sent,bytes_sent,"
+                  "messages_received,bytes_received,vertices_removed,"
+                  "edges_removed\n");
+
+    for (nid_int s=0; s<supersteps; s++) {
+        for (uint q=0; q<n; q++) {
+            double *r = &(rows[STATS_FIELDS * (q * supersteps + s)]);
+
+            fprintf(file, NID_FORMAT ",%u,%.9f,%.9f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n",
+                    s, q, r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+        }
+    }
+
+    fclose(file);
+}
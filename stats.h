@@ -0,0 +1,61 @@
+
+/**
+ * Start measuring the supersteps of this process.
+ *
+ * Before this function is called, synchronisations and communication are
+ * not recorded.
+ */
+void start_stats(void);
+
+/**
+ * Put data in the memory of another process, and record the communication.
+ *
+ * The parameters are the same as those of `bsp_put`.
+ */
+void counted_put(uint pid, const void *src, void *dst, size_t offset, 
+                 size_t nbytes);
+
+/**
+ * Synchronise all processes, and record how long the superstep took.
+ */
+void counted_sync(void);
+
+/**
+ * Record how much of the graph was removed in the current superstep.
+ *
+ * Parameters:
+ * - `vertices`     Amount of vertices that were removed.
+ * - `edges`        Amount of edges that were removed with those vertices.
+ */
+void count_removed(nid_int vertices, nid_int edges);
+
+/**
+ * Print a summary of the recorded supersteps, with the BSP cost
+ * w + g*h + l of the run and the imbalance between processes.
+ *
+ * Every process needs to call this function, but only PID 0 prints.
+ *
+ * Parameters:
+ * - `csv_path`     File that will store the measurements of every process in
+ *                  every superstep, or NULL to skip the file.
+ * - `g`            Time in seconds to communicate one byte.
+ * - `l`            Time in seconds of a synchronisation.
+ */
+void report_stats(const char *csv_path, double g, double l);
+
+/**
+ * Read the BSP machine parameters from a file that the probe program wrote.
+ *
+ * Parameters:
+ * - `path`     File to read.
+ * - `g`        Will store the time in seconds to communicate one byte.
+ * - `l`        Will store the time in seconds of a synchronisation.
+ *
+ * Returns:     Whether the file contained both parameters.
+ */
+bool load_bsp_parameters(const char *path, double *g, double *l);
+
+/**
+ * Stop measuring and erase the recorded supersteps from memory.
+ */
+void unallocate_stats(void);
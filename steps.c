@@ -1,6 +1,9 @@
 #include "divide.h"
 #include "graph.h"
 #include "instructions.h"
+#include "stats.h"
+#include "trace.h"
+#include "utilities.h"
 
 /**
  * Ask for the graph's size on stdin.
@@ -12,7 +15,20 @@
 void prompt_graph_size(nid_int *nodes, nid_int *edges) {
     printf("Let's initialize the graph! Give me the graph data, please.\n");
     fflush(stdout);
-    scanf("%u %u", nodes, edges);
+    scanf(NID_FORMAT " " NID_FORMAT, nodes, edges);
+}
+
+/**
+ * Read the size of the next graph on stdin, without asking for it.
+ *
+ * Parameters:
+ * - `nodes`    Integer that will store the amount of vertices in the graph.
+ * - `edges`    Integer that will store the amount of edges in the graph.
+ *
+ * Returns:     Whether there was another graph.
+ */
+bool scan_graph_size(nid_int *nodes, nid_int *edges) {
+    return scanf(NID_FORMAT " " NID_FORMAT, nodes, edges) == 2;
 }
 
 /**
@@ -24,7 +40,7 @@ void prompt_graph_size(nid_int *nodes, nid_int *edges) {
  */
 void prompt_edge(nid_int *node_one, nid_int *node_two) {
     fflush(stdout);
-    scanf("%u %u", node_one, node_two);
+    scanf(NID_FORMAT " " NID_FORMAT, node_one, node_two);
 }
 
 /**
@@ -46,6 +62,47 @@ void prompt_edges(nid_int (*edges)[2], nid_int total_edges) {
     }
 }
 
+/**
+ * Ask for all edges in a graph with sparse vertex IDs. The IDs are kept as
+ * they are.
+ *
+ * Parameters:
+ * - `edges`        Array that will store all the edges.
+ * - `total_edges`  How many edges are expected.
+ */
+void prompt_sparse_edges(xid_int (*edges)[2], nid_int total_edges) {
+    fflush(stdout);
+
+    for (nid_int i=0; i<total_edges; i++) {
+        scanf(XID_FORMAT " " XID_FORMAT, &(edges[i][0]), &(edges[i][1]));
+    }
+}
+
+/**
+ * Ask for all edges in a weighted graph, with the weight of every edge after
+ * its vertices.
+ *
+ * Parameters:
+ * - `edges`        Array that will store all the edges.
+ * - `weights`      Array that will store the weight of every edge.
+ * - `total_edges`  How many edges are expected.
+ */
+void prompt_weighted_edges(nid_int (*edges)[2], double *weights,
+                           nid_int total_edges) {
+    fflush(stdout);
+
+    for (nid_int i=0; i<total_edges; i++) {
+        nid_int node_one;
+        nid_int node_two;
+
+        scanf(NID_FORMAT " " NID_FORMAT " %lf", &node_one, &node_two, 
+              &(weights[i]));
+
+        edges[i][0] = node_one - 1;
+        edges[i][1] = node_two - 1;
+    }
+}
+
 /**
  * Broadcast to each process how many nodes they should expect.
  *
@@ -72,7 +129,7 @@ void broadcast_node_amount(nid_int total_nodes, nid_int *sync_number) {
 
     // Send the amounts
     for (uint i=0; i<n; i++) {
-        bsp_put(i, &(node_distr[i]), sync_number, 0, sizeof(nid_int));
+        counted_put(i, &(node_distr[i]), sync_number, 0, sizeof(nid_int));
     }
 
     free(node_distr);
@@ -90,10 +147,60 @@ void broadcast_total_node_amount(nid_int *sync_number) {
     uint n = bsp_nprocs();
 
     for (uint i=0; i<n; i++) {
-        bsp_put(i, sync_number, sync_number, 0, sizeof(nid_int));
+        counted_put(i, sync_number, sync_number, 0, sizeof(nid_int));
     }
 }
 
+/**
+ * Read the next edge of an input graph. Start with a cursor of zeros.
+ *
+ * A graph structure lists every edge twice, so only the direction from the
+ * lower to the higher vertex counts.
+ *
+ * Parameters:
+ * - `input`    Graph to read.
+ * - `cursor`   Position in the graph, which moves past the edge.
+ * - `edge`     Will store the edge.
+ *
+ * Returns:     Whether there was another edge.
+ */
+bool next_input_edge(const struct input_graph *input, nid_int cursor[2],
+                     nid_int edge[2]) {
+    if (input->csr == NULL) {
+        if (cursor[0] >= input->edges_length) {
+            return false;
+        }
+        edge[0] = input->edges[cursor[0]][0];
+        edge[1] = input->edges[cursor[0]][1];
+        cursor[0]++;
+
+        return true;
+    }
+
+    // The cursor holds the vertex and the position in its targets.
+    const struct csr_graph *csr = input->csr;
+
+    while (cursor[0] < csr->nodes) {
+        if (cursor[1] < csr->offsets[cursor[0]]) {
+            cursor[1] = csr->offsets[cursor[0]];
+        }
+
+        while (cursor[1] < csr->offsets[cursor[0] + 1]) {
+            nid_int w = csr->targets[cursor[1]++];
+
+            if (cursor[0] < w) {
+                edge[0] = cursor[0];
+                edge[1] = w;
+
+                return true;
+            }
+        }
+        cursor[0]++;
+    }
+
+    return false;
+}
+
 /**
  * Broadcast to each process how many edges they should expect.
  *
@@ -101,14 +208,13 @@ void broadcast_total_node_amount(nid_int *sync_number) {
  * be allocated by each process.
  *
  * Parameters:
- * - `edges`        Array that stores every edge in the graph.
- * - `total_edges`  How many edges the graph has in total.
- * - `total_nodes`  How many nodes the graph has in total.
+ * - `input`        Graph to match.
  * - `sync_number`  The pushed BSP register where each number may be stored.
  */
-void broadcast_edge_amount(nid_int (*edges)[2], nid_int total_edges,
-                           nid_int total_nodes, nid_int *sync_number) {
+void broadcast_edge_amount(const struct input_graph *input,
+                           nid_int *sync_number) {
     uint n = bsp_nprocs();
+    nid_int total_nodes = input->nodes;
 
     // Initialize edge table
     nid_int *edge_distr = malloc(n * sizeof(nid_int));
@@ -117,9 +223,12 @@ void broadcast_edge_amount(nid_int (*edges)[2], nid_int total_edges,
     }
 
     // Count processes for which the edge is relevant
-    for (nid_int i=0; i<total_edges; i++) {
-        nid_int node_one = edges[i][0];
-        nid_int node_two = edges[i][1];
+    nid_int cursor[2] = {0, 0};
+    nid_int edge[2];
+
+    while (next_input_edge(input, cursor, edge)) {
+        nid_int node_one = edge[0];
+        nid_int node_two = edge[1];
 
         uint p1 = divide(node_one, total_nodes, n);
         uint p2 = divide(node_two, total_nodes, n);
@@ -132,7 +241,7 @@ void broadcast_edge_amount(nid_int (*edges)[2], nid_int total_edges,
 
     // Send the amounts to the respective processes
     for (uint i=0; i<n; i++) {
-        bsp_put(i, &(edge_distr[i]), sync_number, 0, sizeof(nid_int));
+        counted_put(i, &(edge_distr[i]), sync_number, 0, sizeof(nid_int));
     }
 
     free(edge_distr);
@@ -142,14 +251,15 @@ void broadcast_edge_amount(nid_int (*edges)[2], nid_int total_edges,
  * Broadcast all edges to the relevant processes.
  *
  * Parameters:
- * - `edges`        Array that stores every edge in the graph.
- * - `total_edges`  How many edges the graph has in total.
- * - `total_nodes`  How many nodes the graph has in total.
- * - `sync_number`  The pushed BSP register where every edge may be stored.
+ * - `input`        Graph to match.
+ * - `sync_array`   The pushed BSP register where every edge may be stored.
+ * - `sync_weights` The pushed BSP register where the weight of every edge
+ *                  may be stored. Unused for an unweighted graph.
  */
-void send_edges(nid_int (*edges)[2], nid_int total_edges, 
-                nid_int total_nodes, nid_int (*sync_array)[2]) {
+void send_edges(const struct input_graph *input, nid_int (*sync_array)[2],
+                double *sync_weights) {
     uint n = bsp_nprocs();
+    nid_int total_nodes = input->nodes;
 
     // Keep track of how many edges have been broadcast yet.
     nid_int *edges_found = malloc(n * sizeof(nid_int));
@@ -157,20 +267,37 @@ void send_edges(nid_int (*edges)[2], nid_int total_edges,
         edges_found[i] = 0;
     }
 
-    for (nid_int i=0; i<total_edges; i++) {
-        nid_int node_one = edges[i][0];
-        nid_int node_two = edges[i][1];
+    // A put copies the edge right away, so it may live on the stack.
+    nid_int cursor[2] = {0, 0};
+    nid_int edge[2];
+
+    while (next_input_edge(input, cursor, edge)) {
+        nid_int node_one = edge[0];
+        nid_int node_two = edge[1];
 
         uint p1 = divide(node_one, total_nodes, n);
         uint p2 = divide(node_two, total_nodes, n);
 
-        bsp_put(p1, &(edges[i]), sync_array, edges_found[p1]*2*sizeof(nid_int),
+        // Weights only come with an edge array, whose cursor is the position
+        // after the edge.
+        double *weight = (input->weights != NULL) ? 
+                         &(input->weights[cursor[0] - 1]) : NULL;
+
+        counted_put(p1, edge, sync_array, edges_found[p1]*2*sizeof(nid_int),
                 2*sizeof(nid_int));
+        if (weight != NULL) {
+            counted_put(p1, weight, sync_weights, 
+                        edges_found[p1]*sizeof(double), sizeof(double));
+        }
         edges_found[p1]++;
 
         if (p2 != p1) {
-            bsp_put(p2, &(edges[i]), sync_array, edges_found[p2]*2*sizeof(nid_int),
+            counted_put(p2, edge, sync_array, edges_found[p2]*2*sizeof(nid_int),
                 2*sizeof(nid_int));
+            if (weight != NULL) {
+                counted_put(p2, weight, sync_weights, 
+                            edges_found[p2]*sizeof(double), sizeof(double));
+            }
             edges_found[p2]++;
         }
     }
@@ -178,6 +305,109 @@ void send_edges(nid_int (*edges)[2], nid_int total_edges,
     free(edges_found);
 }
 
+/**
+ * Drop the self-loops and duplicate edges that this process received, so
+ * that no vertex lists the same neighbour twice. A sorted copy of the edges
+ * finds the duplicates, and the first copy of every edge stays where it was,
+ * so that a graph without duplicates is matched exactly as before. The copy
+ * that stays gets the highest weight of all copies.
+ *
+ * Both processes of an edge between two processes receive every copy of it,
+ * so they drop the same copies without communication.
+ *
+ * Parameters:
+ * - `edges`        Array of edges of this process. Only the first copy of
+ *                  every edge remains, at the start of the array.
+ * - `weights`      Weight of every edge, which stays with its edge, or NULL
+ *                  for an unweighted graph.
+ * - `edges_length` Array length of parameter `edges`.
+ * - `total_nodes`  How many nodes the graph has in total.
+ * - `dropped`      Array that will store the amount of dropped self-loops and
+ *                  duplicates. A duplicate between two processes only counts
+ *                  on the process of its smallest vertex, so that the sums
+ *                  across processes count every edge once.
+ *
+ * Returns:         Amount of remaining edges.
+ */
+nid_int clean_edges(nid_int (*edges)[2], double *weights,
+                    nid_int edges_length, nid_int total_nodes,
+                    nid_int dropped[2]) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    dropped[0] = 0;
+    dropped[1] = 0;
+
+    // Every edge with its smallest vertex first, and its position.
+    nid_int (*sorted)[3] = malloc((edges_length + 1) * sizeof(nid_int[3]));
+    bool *keep           = malloc((edges_length + 1) * sizeof(bool));
+
+    for (nid_int i=0; i<edges_length; i++) {
+        nid_int a = edges[i][0];
+        nid_int b = edges[i][1];
+
+        sorted[i][0] = a < b ? a : b;
+        sorted[i][1] = a < b ? b : a;
+        sorted[i][2] = i;
+        keep[i]      = (a != b);
+
+        if (a == b) {
+            dropped[0]++;
+        }
+    }
+    qsort(sorted, edges_length, sizeof(nid_int[3]), compare_edges);
+
+    // Within a run of copies, keep the one that came first.
+    nid_int start = 0;
+
+    while (start < edges_length) {
+        nid_int end   = start + 1;
+        nid_int first = sorted[start][2];
+
+        while (end < edges_length && 
+               compare_edges(sorted[start], sorted[end]) == 0) {
+            first = sorted[end][2] < first ? sorted[end][2] : first;
+            end++;
+        }
+
+        if (sorted[start][0] != sorted[start][1]) {
+            for (nid_int i=start; i<end; i++) {
+                keep[sorted[i][2]] = (sorted[i][2] == first);
+
+                if (weights != NULL && 
+                    weights[sorted[i][2]] > weights[first]) {
+                    weights[first] = weights[sorted[i][2]];
+                }
+            }
+
+            if (divide(sorted[start][0], total_nodes, n) == p) {
+                dropped[1] = dropped[1] + (end - start - 1);
+            }
+        }
+
+        start = end;
+    }
+
+    nid_int length = 0;
+
+    for (nid_int i=0; i<edges_length; i++) {
+        if (keep[i]) {
+            edges[length][0] = edges[i][0];
+            edges[length][1] = edges[i][1];
+
+            if (weights != NULL) {
+                weights[length] = weights[i];
+            }
+            length++;
+        }
+    }
+
+    free(sorted);
+    free(keep);
+
+    return length;
+}
+
 /**
  * Calculate the maximum amount of nodes that may be expected in the process
  * based on the edges we have available.
@@ -266,19 +496,25 @@ bool already_exists(nid_int n, struct node **nodes, nid_int nodes_length) {
     }
 }
 
+/**
+ * Write all received instructions to the trace.
+ *
+ * Parameters:
+ * - `response`         Array of received instructions.
+ * - `response_length`  Array length of parameter `response`.
+ */
 void debug_instruction_response(struct instruction *response, 
                                 nid_int response_length) {
-    uint n = bsp_nprocs();
-    uint p = bsp_pid();
-    
-    for (uint i=0; i<n; i++) {
-        if (i==p) {
-            printf("==================\nPID %u received these instructions:\n", p);
-
-            for (nid_int j=0; j<response_length; j++) {
-                show_instruction(response[j]);
-            }
-        }
-        bsp_sync();
+#if TRACE_LEVEL >= TRACE_CHANGES
+    for (nid_int j=0; j<response_length; j++) {
+        TRACE(TRACE_CHANGES, "Received instruction %d [ " NID_FORMAT " "
+              NID_FORMAT " " NID_FORMAT " " NID_FORMAT " ]", 
+              response[j].value, response[j].content[0], 
+              response[j].content[1], response[j].content[2], 
+              response[j].content[3]);
     }
+#else
+    (void) response;
+    (void) response_length;
+#endif
 }
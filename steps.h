@@ -7,6 +7,17 @@
  */
 void prompt_graph_size(nid_int *nodes, nid_int *edges);
 
+/**
+ * Read the size of the next graph on stdin, without asking for it.
+ *
+ * Parameters:
+ * - `nodes`    Integer that will store the amount of vertices in the graph.
+ * - `edges`    Integer that will store the amount of edges in the graph.
+ *
+ * Returns:     Whether there was another graph.
+ */
+bool scan_graph_size(nid_int *nodes, nid_int *edges);
+
 /**
  * Ask for an edge on stdin.
  *
@@ -25,6 +36,28 @@ void prompt_edge(nid_int *node_one, nid_int *node_two);
  */
 void prompt_edges(nid_int (*edges)[2], nid_int total_edges);
 
+/**
+ * Ask for all edges in a graph with sparse vertex IDs. The IDs are kept as
+ * they are.
+ *
+ * Parameters:
+ * - `edges`        Array that will store all the edges.
+ * - `total_edges`  How many edges are expected.
+ */
+void prompt_sparse_edges(xid_int (*edges)[2], nid_int total_edges);
+
+/**
+ * Ask for all edges in a weighted graph, with the weight of every edge after
+ * its vertices.
+ *
+ * Parameters:
+ * - `edges`        Array that will store all the edges.
+ * - `weights`      Array that will store the weight of every edge.
+ * - `total_edges`  How many edges are expected.
+ */
+void prompt_weighted_edges(nid_int (*edges)[2], double *weights,
+                           nid_int total_edges);
+
 /**
  * Broadcast to each process how many nodes they should expect.
  *
@@ -47,6 +80,22 @@ void broadcast_node_amount(nid_int total_nodes, nid_int *sync_number);
  */
 void broadcast_total_node_amount(nid_int *sync_number);
 
+/**
+ * Read the next edge of an input graph. Start with a cursor of zeros.
+ *
+ * A graph structure lists every edge twice, so only the direction from the
+ * lower to the higher vertex counts.
+ *
+ * Parameters:
+ * - `input`    Graph to read.
+ * - `cursor`   Position in the graph, which moves past the edge.
+ * - `edge`     Will store the edge.
+ *
+ * Returns:     Whether there was another edge.
+ */
+bool next_input_edge(const struct input_graph *input, nid_int cursor[2],
+                     nid_int edge[2]);
+
 /**
  * Broadcast to each process how many edges they should expect.
  *
@@ -54,25 +103,51 @@ void broadcast_total_node_amount(nid_int *sync_number);
  * be allocated by each process.
  *
  * Parameters:
- * - `edges`        Array that stores every edge in the graph.
- * - `total_edges`  How many edges the graph has in total.
- * - `total_nodes`  How many nodes the graph has in total.
+ * - `input`        Graph to match.
  * - `sync_number`  The pushed BSP register where each number may be stored.
  */
-void broadcast_edge_amount(nid_int (*edges)[2], nid_int total_edges,
-                           nid_int total_nodes, nid_int *sync_number);
+void broadcast_edge_amount(const struct input_graph *input,
+                           nid_int *sync_number);
 
 /**
  * Broadcast all edges to the relevant processes.
  *
  * Parameters:
- * - `edges`        Array that stores every edge in the graph.
- * - `total_edges`  How many edges the graph has in total.
+ * - `input`        Graph to match.
+ * - `sync_array`   The pushed BSP register where every edge may be stored.
+ * - `sync_weights` The pushed BSP register where the weight of every edge
+ *                  may be stored. Unused for an unweighted graph.
+ */
+void send_edges(const struct input_graph *input, nid_int (*sync_array)[2],
+                double *sync_weights);
+
+/**
+ * Drop the self-loops and duplicate edges that this process received, so
+ * that no vertex lists the same neighbour twice. A sorted copy of the edges
+ * finds the duplicates, and the first copy of every edge stays where it was,
+ * so that a graph without duplicates is matched exactly as before. The copy
+ * that stays gets the highest weight of all copies.
+ *
+ * Both processes of an edge between two processes receive every copy of it,
+ * so they drop the same copies without communication.
+ *
+ * Parameters:
+ * - `edges`        Array of edges of this process. Only the first copy of
+ *                  every edge remains, at the start of the array.
+ * - `weights`      Weight of every edge, which stays with its edge, or NULL
+ *                  for an unweighted graph.
+ * - `edges_length` Array length of parameter `edges`.
  * - `total_nodes`  How many nodes the graph has in total.
- * - `sync_number`  The pushed BSP register where every edge may be stored.
+ * - `dropped`      Array that will store the amount of dropped self-loops and
+ *                  duplicates. A duplicate between two processes only counts
+ *                  on the process of its smallest vertex, so that the sums
+ *                  across processes count every edge once.
+ *
+ * Returns:         Amount of remaining edges.
  */
-void send_edges(nid_int (*edges)[2], nid_int total_edges, 
-                nid_int total_nodes, nid_int (*sync_array)[2]);
+nid_int clean_edges(nid_int (*edges)[2], double *weights,
+                    nid_int edges_length, nid_int total_nodes,
+                    nid_int dropped[2]);
 
 /**
  * Calculate the maximum amount of nodes that may be expected in the process
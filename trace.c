@@ -0,0 +1,309 @@
+#include "trace.h"
+
+// BSP processes may be threads of the same program, 
+// so every process keeps its own trace.
+static _Thread_local struct trace_ring *TRACE_RING = NULL;
+static _Thread_local struct timeline   *TIMELINE   = NULL;
+
+// The amount of values per phase that every process reports to PID 0.
+#define TIMELINE_FIELDS 4
+
+// Names of the PHASE_* values in the trace viewer.
+static const char *TIMELINE_NAMES[] = {
+    "load_structure",
+    "solve_small_components",
+    "remove_singletons",
+    "send_instructions",
+    "interpret_instructions",
+    "clean_edges",
+    "match_dominant_edges",
+};
+
+// PRIVATE FUNCTIONS
+void write_timeline(const char *json_path, double *events, nid_int *lengths);
+
+/**
+ * Start tracing this process.
+ *
+ * In release builds, this function does nothing.
+ */
+void start_trace(void) {
+#if TRACE_LEVEL > 0
+    TRACE_RING = malloc(sizeof(struct trace_ring));
+
+    TRACE_RING->times   = malloc(TRACE_RING_SIZE * sizeof(double));
+    TRACE_RING->lines   = malloc(TRACE_RING_SIZE * TRACE_LINE_LENGTH);
+    TRACE_RING->next    = 0;
+    TRACE_RING->length  = 0;
+    TRACE_RING->dropped = 0;
+#endif
+}
+
+/**
+ * Write a message to the trace of this process.
+ *
+ * Use the `TRACE` macro instead, so that the call disappears in release
+ * builds.
+ *
+ * Parameters:
+ * - `format`   Format string, like that of `printf`.
+ */
+void trace_write(const char *format, ...) {
+    // Threads within a process don't have a trace.
+    if (TRACE_RING == NULL) {
+        return;
+    }
+
+    nid_int i = TRACE_RING->next;
+
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(TRACE_RING->lines[i], TRACE_LINE_LENGTH, format, arguments);
+    va_end(arguments);
+
+    TRACE_RING->times[i] = bsp_time();
+    TRACE_RING->next     = (i + 1) % TRACE_RING_SIZE;
+
+    if (TRACE_RING->length < TRACE_RING_SIZE) {
+        TRACE_RING->length++;
+    } else {
+        TRACE_RING->dropped++;
+    }
+}
+
+/**
+ * Write a message that ends with an array of numbers.
+ *
+ * Messages that don't fit in a trace line are cut off.
+ *
+ * Parameters:
+ * - `label`        Text in front of the numbers.
+ * - `nums`         Array of numbers.
+ * - `nums_length`  Array length of parameter `nums`.
+ */
+void trace_numbers(const char *label, nid_int *nums, nid_int nums_length) {
+    char line[TRACE_LINE_LENGTH];
+    int  size = snprintf(line, TRACE_LINE_LENGTH, "%s [ ", label);
+
+    for (nid_int i=0; i<nums_length && size < TRACE_LINE_LENGTH; i++) {
+        size = size + snprintf(&(line[size]), TRACE_LINE_LENGTH - size, 
+                               NID_FORMAT " ", nums[i]);
+    }
+
+    if (size < TRACE_LINE_LENGTH) {
+        snprintf(&(line[size]), TRACE_LINE_LENGTH - size, "]");
+    }
+
+    trace_write("%s", line);
+}
+
+/**
+ * Write the trace of this process to its file, and erase it from memory.
+ *
+ * No process needs to wait for any other, so this costs no synchronisation.
+ * In release builds, this function does nothing.
+ */
+void dump_trace(void) {
+#if TRACE_LEVEL > 0
+    char path[64];
+    snprintf(path, sizeof(path), TRACE_PATH, bsp_pid());
+
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "[PID %u] Cannot write the trace to %s.\n", 
+                bsp_pid(), path);
+    } else {
+        if (TRACE_RING->dropped > 0) {
+            fprintf(file, "(" NID_FORMAT " older messages were dropped)\n", 
+                    TRACE_RING->dropped);
+        }
+
+        nid_int first = (TRACE_RING->next + TRACE_RING_SIZE - 
+                         TRACE_RING->length) % TRACE_RING_SIZE;
+
+        for (nid_int j=0; j<TRACE_RING->length; j++) {
+            nid_int i = (first + j) % TRACE_RING_SIZE;
+
+            fprintf(file, "[PID %u] %.6f %s\n", 
+                    bsp_pid(), TRACE_RING->times[i], TRACE_RING->lines[i]);
+        }
+
+        fclose(file);
+    }
+
+    free(TRACE_RING->times);
+    free(TRACE_RING->lines);
+    free(TRACE_RING);
+    TRACE_RING = NULL;
+#endif
+}
+
+/**
+ * Start recording the timeline of this process.
+ *
+ * Before this function is called, phases are not recorded.
+ */
+void start_timeline(void) {
+    TIMELINE = malloc(sizeof(struct timeline));
+
+    TIMELINE->length     = 0;
+    TIMELINE->max_length = 256;
+    TIMELINE->events     = malloc(TIMELINE_FIELDS * TIMELINE->max_length * 
+                                  sizeof(double));
+}
+
+/**
+ * Record that this process spent the time from `start` until now in a phase.
+ *
+ * Parameters:
+ * - `phase`    One of the PHASE_* values.
+ * - `round`    Round of the superstep loop that the phase belongs to.
+ * - `start`    Value of `bsp_time()` at the start of the phase.
+ */
+void record_phase(short int phase, nid_int round, double start) {
+    if (TIMELINE == NULL) {
+        return;
+    }
+
+    if (TIMELINE->length == TIMELINE->max_length) {
+        TIMELINE->max_length = 2 * TIMELINE->max_length;
+        TIMELINE->events     = realloc(TIMELINE->events, TIMELINE_FIELDS * 
+                                       TIMELINE->max_length * sizeof(double));
+    }
+
+    double *event = &(TIMELINE->events[TIMELINE_FIELDS * TIMELINE->length]);
+    event[0] = phase;
+    event[1] = round;
+    event[2] = start;
+    event[3] = bsp_time();
+
+    TIMELINE->length++;
+}
+
+/**
+ * Write the timelines of all processes to a Chrome trace-event JSON file,
+ * which trace viewers like Perfetto can open.
+ *
+ * Every process needs to call this function, but only PID 0 writes.
+ *
+ * Parameters:
+ * - `json_path`    File to write to.
+ */
+void report_timeline(const char *json_path) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    // Tell PID 0 how many phases every process recorded.
+    nid_int *lengths = malloc(n * sizeof(nid_int));
+    bsp_push_reg(lengths, n * sizeof(nid_int));
+    bsp_sync();
+
+    bsp_put(0, &(TIMELINE->length), lengths, p * sizeof(nid_int), 
+            sizeof(nid_int));
+    bsp_sync();
+    bsp_pop_reg(lengths);
+
+    // PID 0 tells every process where its phases go.
+    nid_int offset = 0;
+    nid_int total  = 0;
+    bsp_push_reg(&offset, sizeof(nid_int));
+    bsp_sync();
+
+    if (p == 0) {
+        for (uint q=0; q<n; q++) {
+            bsp_put(q, &total, &offset, 0, sizeof(nid_int));
+            total = total + lengths[q];
+        }
+    }
+    bsp_sync();
+    bsp_pop_reg(&offset);
+
+    // Collect the phases of all processes.
+    double *events = malloc((TIMELINE_FIELDS * total + 1) * sizeof(double));
+    bsp_push_reg(events, TIMELINE_FIELDS * total * sizeof(double));
+    bsp_sync();
+
+    bsp_put(0, TIMELINE->events, events, 
+            TIMELINE_FIELDS * offset * sizeof(double), 
+            TIMELINE_FIELDS * TIMELINE->length * sizeof(double));
+    bsp_sync();
+    bsp_pop_reg(events);
+
+    if (p == 0) {
+        write_timeline(json_path, events, lengths);
+    }
+
+    free(lengths);
+    free(events);
+}
+
+/**
+ * Stop recording and erase the timeline from memory.
+ */
+void unallocate_timeline(void) {
+    if (TIMELINE == NULL) {
+        return;
+    }
+
+    free(TIMELINE->events);
+    free(TIMELINE);
+    TIMELINE = NULL;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Write the phases of every process to a Chrome trace-event JSON file.
+ *
+ * Every process shows up as a thread, so that the viewer puts their
+ * timelines below each other.
+ *
+ * Parameters:
+ * - `json_path`    File to write to.
+ * - `events`       Phases of every process, in order of PID.
+ * - `lengths`      Amount of phases of every process.
+ */
+void write_timeline(const char *json_path, double *events, nid_int *lengths) {
+    FILE *file = fopen(json_path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write the timeline to %s.\n", json_path);
+        return;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+    nid_int e = 0;
+    for (uint q=0; q<bsp_nprocs(); q++) {
+        fprintf(file, "  {\"name\": \"thread_name\", \"ph\": \"M\", "
+                      "\"pid\": 0, \"tid\": %u, "
+                      "\"args\": {\"name\": \"PID %u\"}}", q, q);
+
+        for (nid_int i=0; i<lengths[q]; i++, e++) {
+            double *event = &(events[TIMELINE_FIELDS * e]);
+
+            // Trace viewers expect times in microseconds.
+            fprintf(file, ",\n  {\"name\": \"%s\", \"ph\": \"X\", "
+                          "\"pid\": 0, \"tid\": %u, "
+                          "\"ts\": %.3f, \"dur\": %.3f, "
+                          "\"args\": {\"round\": %.0f}}",
+                    TIMELINE_NAMES[(int) event[0]], q, 1e6 * event[2], 
+                    1e6 * (event[3] - event[2]), event[1]);
+        }
+
+        fprintf(file, q + 1 < bsp_nprocs() ? ",\n" : "\n");
+    }
+
+    fprintf(file, "]}\n");
+    fclose(file);
+}
@@ -0,0 +1,93 @@
+
+// The tracing levels. See TRACE_LEVEL in main.h.
+#define TRACE_ROUNDS  1
+#define TRACE_CHANGES 2
+#define TRACE_GRAPH   3
+
+/**
+ * Write a message to the trace of this process, if its level is traced.
+ *
+ * The arguments after `level` are the same as those of `printf`. In release
+ * builds, the macro and its arguments disappear from the program.
+ */
+#if TRACE_LEVEL > 0
+#define TRACE(level, ...)                       \
+    do {                                        \
+        if ((level) <= TRACE_LEVEL) {           \
+            trace_write(__VA_ARGS__);           \
+        }                                       \
+    } while (0)
+#else
+#define TRACE(level, ...) do { } while (0)
+#endif
+
+/**
+ * Start tracing this process.
+ *
+ * In release builds, this function does nothing.
+ */
+void start_trace(void);
+
+/**
+ * Write a message to the trace of this process.
+ *
+ * Use the `TRACE` macro instead, so that the call disappears in release
+ * builds.
+ *
+ * Parameters:
+ * - `format`   Format string, like that of `printf`.
+ */
+void trace_write(const char *format, ...);
+
+/**
+ * Write a message that ends with an array of numbers.
+ *
+ * Messages that don't fit in a trace line are cut off.
+ *
+ * Parameters:
+ * - `label`        Text in front of the numbers.
+ * - `nums`         Array of numbers.
+ * - `nums_length`  Array length of parameter `nums`.
+ */
+void trace_numbers(const char *label, nid_int *nums, nid_int nums_length);
+
+/**
+ * Write the trace of this process to its file, and erase it from memory.
+ *
+ * No process needs to wait for any other, so this costs no synchronisation.
+ * In release builds, this function does nothing.
+ */
+void dump_trace(void);
+
+/**
+ * Start recording the timeline of this process.
+ *
+ * Before this function is called, phases are not recorded.
+ */
+void start_timeline(void);
+
+/**
+ * Record that this process spent the time from `start` until now in a phase.
+ *
+ * Parameters:
+ * - `phase`    One of the PHASE_* values.
+ * - `round`    Round of the superstep loop that the phase belongs to.
+ * - `start`    Value of `bsp_time()` at the start of the phase.
+ */
+void record_phase(short int phase, nid_int round, double start);
+
+/**
+ * Write the timelines of all processes to a Chrome trace-event JSON file,
+ * which trace viewers like Perfetto can open.
+ *
+ * Every process needs to call this function, but only PID 0 writes.
+ *
+ * Parameters:
+ * - `json_path`    File to write to.
+ */
+void report_timeline(const char *json_path);
+
+/**
+ * Stop recording and erase the timeline from memory.
+ */
+void unallocate_timeline(void);
@@ -1,3 +1,4 @@
+#include "stats.h"
 #include "utilities.h"
 
 /**
@@ -9,12 +10,12 @@ void exchange_numbers_all_to_all(nid_int *numbers) {
     uint p = bsp_pid();
 
     bsp_push_reg(numbers, n*sizeof(nid_int));
-    bsp_sync();
+    counted_sync();
 
     for (uint i=0; i<n; i++) {
-        bsp_put(i, &(numbers[i]), numbers, p*sizeof(nid_int), sizeof(nid_int));
+        counted_put(i, &(numbers[i]), numbers, p*sizeof(nid_int), sizeof(nid_int));
     }
-    bsp_sync();
+    counted_sync();
     bsp_pop_reg(numbers);
 }
 
@@ -31,27 +32,19 @@ nid_int max(nid_int *nums, uint n) {
 }
 
 nid_int unique(nid_int *nums, nid_int n) {
-    nid_int *unique_values = malloc(n * sizeof(nid_int));
+    nid_int *sorted_values = malloc((n + 1) * sizeof(nid_int));
     nid_int unique_length  = 0;
 
-    for (nid_int i=0; i<n; i++) {
-        nid_int value = nums[i];
-        bool seen_before = false;
-
-        for (nid_int j=0; j<unique_length; j++) {
-            if (unique_values[j] == value) {
-                seen_before = true;
-                break;
-            }
-        }
+    memcpy(sorted_values, nums, n * sizeof(nid_int));
+    qsort(sorted_values, n, sizeof(nid_int), compare_nids);
 
-        if (!seen_before) {
-            unique_values[unique_length] = value;
+    for (nid_int i=0; i<n; i++) {
+        if (i == 0 || sorted_values[i-1] != sorted_values[i]) {
             unique_length++;
         }
     }
 
-    free(unique_values);
+    free(sorted_values);
     return unique_length;
 }
 
@@ -63,4 +56,197 @@ nid_int sum(nid_int *nums, uint n) {
     }
 
     return total;
-}
\ No newline at end of file
+}
+
+/**
+ * Compare two node identifiers. Used to sort arrays with `qsort`.
+ */
+int compare_nids(const void *a, const void *b) {
+    nid_int x = *((const nid_int *) a);
+    nid_int y = *((const nid_int *) b);
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Compare two edges, first by their first vertex and then by their second.
+ * Used to sort arrays with `qsort`.
+ */
+int compare_edges(const void *a, const void *b) {
+    const nid_int *x = a;
+    const nid_int *y = b;
+
+    if (x[0] != y[0]) {
+        return (x[0] > y[0]) - (x[0] < y[0]);
+    }
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+/**
+ * Find a value in a sorted array through binary search.
+ *
+ * Returns:     The index of the value, or `n` if the array doesn't contain it.
+ */
+nid_int search_sorted(nid_int *nums, nid_int n, nid_int value) {
+    nid_int low  = 0;
+    nid_int high = n;
+
+    while (low < high) {
+        nid_int middle = low + (high - low) / 2;
+
+        if (nums[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < n && nums[low] == value) {
+        return low;
+    }
+    return n;
+}
+
+/**
+ * Sum a number across all processes. Every process receives the total.
+ */
+nid_int sum_across_processes(nid_int value) {
+    uint n = bsp_nprocs();
+
+    nid_int *numbers = malloc(n * sizeof(nid_int));
+    for (uint i=0; i<n; i++) {
+        numbers[i] = value;
+    }
+
+    exchange_numbers_all_to_all(numbers);
+
+    nid_int total = sum(numbers, n);
+    free(numbers);
+    return total;
+}
+
+/**
+ * Sum a weight across all processes. Every process receives the total.
+ */
+double sum_weight_across_processes(double value) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    double *weights = malloc(n * sizeof(double));
+
+    bsp_push_reg(weights, n * sizeof(double));
+    counted_sync();
+
+    for (uint i=0; i<n; i++) {
+        counted_put(i, &value, weights, p * sizeof(double), sizeof(double));
+    }
+    counted_sync();
+    bsp_pop_reg(weights);
+
+    // Every process adds in the same order, so they get the same total.
+    double total = 0;
+    for (uint i=0; i<n; i++) {
+        total = total + weights[i];
+    }
+
+    free(weights);
+    return total;
+}
+
+/**
+ * Sum several numbers across all processes at once, in a single exchange.
+ * Every process receives the totals in place of its own numbers.
+ */
+void sum_numbers_across_processes(nid_int *numbers, uint length) {
+    uint n = bsp_nprocs();
+    uint p = bsp_pid();
+
+    nid_int *received = malloc(n * length * sizeof(nid_int));
+
+    bsp_push_reg(received, n * length * sizeof(nid_int));
+    counted_sync();
+
+    for (uint i=0; i<n; i++) {
+        counted_put(i, numbers, received, p * length * sizeof(nid_int), 
+                    length * sizeof(nid_int));
+    }
+    counted_sync();
+    bsp_pop_reg(received);
+
+    for (uint k=0; k<length; k++) {
+        numbers[k] = 0;
+
+        for (uint i=0; i<n; i++) {
+            numbers[k] = numbers[k] + received[i * length + k];
+        }
+    }
+
+    free(received);
+}
+
+/**
+ * Set how many threads each parallel region of this process may use.
+ */
+void set_thread_count(uint threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#else
+    (void) threads;
+#endif
+}
+
+/**
+ * The amount of threads that the next parallel region may use.
+ */
+uint max_thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * The amount of threads in the current parallel region.
+ */
+uint thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * The number of the current thread within its parallel region.
+ */
+uint thread_id(void) {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * The time in seconds since an arbitrary moment. Used to measure durations
+ * outside of the BSP processes.
+ */
+double wall_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * The largest amount of memory in KiB that the program has used so far.
+ * BSP processes are threads of the same program, so this includes all of
+ * them.
+ */
+long peak_memory(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_maxrss;
+}
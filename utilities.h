@@ -10,3 +10,70 @@ nid_int max(nid_int *nums, uint n);
 nid_int unique(nid_int *nums, nid_int n);
 
 nid_int sum(nid_int *nums, uint n);
+
+/**
+ * Compare two node identifiers. Used to sort arrays with `qsort`.
+ */
+int compare_nids(const void *a, const void *b);
+
+/**
+ * Compare two edges, first by their first vertex and then by their second.
+ * Used to sort arrays with `qsort`.
+ */
+int compare_edges(const void *a, const void *b);
+
+/**
+ * Find a value in a sorted array through binary search.
+ *
+ * Returns:     The index of the value, or `n` if the array doesn't contain it.
+ */
+nid_int search_sorted(nid_int *nums, nid_int n, nid_int value);
+
+/**
+ * Sum a number across all processes. Every process receives the total.
+ */
+nid_int sum_across_processes(nid_int value);
+
+/**
+ * Sum a weight across all processes. Every process receives the total.
+ */
+double sum_weight_across_processes(double value);
+
+/**
+ * Sum several numbers across all processes at once, in a single exchange.
+ * Every process receives the totals in place of its own numbers.
+ */
+void sum_numbers_across_processes(nid_int *numbers, uint length);
+
+/**
+ * Set how many threads each parallel region of this process may use.
+ */
+void set_thread_count(uint threads);
+
+/**
+ * The amount of threads that the next parallel region may use.
+ */
+uint max_thread_count(void);
+
+/**
+ * The amount of threads in the current parallel region.
+ */
+uint thread_count(void);
+
+/**
+ * The number of the current thread within its parallel region.
+ */
+uint thread_id(void);
+
+/**
+ * The time in seconds since an arbitrary moment. Used to measure durations
+ * outside of the BSP processes.
+ */
+double wall_time(void);
+
+/**
+ * The largest amount of memory in KiB that the program has used so far.
+ * BSP processes are threads of the same program, so this includes all of
+ * them.
+ */
+long peak_memory(void);
@@ -0,0 +1,411 @@
+#include "graph.h"
+#include "instructions.h"
+#include "utilities.h"
+#include "validate.h"
+
+// PRIVATE FUNCTIONS
+nid_int count_free_edges(struct graph *g, nid_int (*edges)[2], 
+                         nid_int edges_length, nid_int *matched, 
+                         nid_int matched_length);
+nid_int count_vertex_cover(struct graph *g, nid_int (*edges)[2], 
+                           nid_int edges_length, nid_int *matched, 
+                           nid_int *partner, nid_int matched_length);
+bool search_edge(nid_int (*edges)[2], nid_int edges_length, nid_int a, 
+                 nid_int b);
+
+/**
+ * Check the matching of all processes against the input graph, and report
+ * how far it can be from a maximum matching.
+ *
+ * The check finds vertices that appear in several matches, matches that are
+ * not edges of the input graph, and edges whose vertices are both free. The
+ * size of a maximum matching is bounded from above by half the amount of
+ * vertices with edges, and by the size of a vertex cover that follows from the
+ * matching if it is maximal.
+ *
+ * Every process needs to call this function, but only PID 0 prints.
+ *
+ * Parameters:
+ * - `g`            Graph structure that holds the matches of this process.
+ * - `edges`        Array of input edges that touch the vertices of this
+ *                  process, as they were received before loading the graph.
+ * - `edges_length` Array length of parameter `edges`.
+ *
+ * Returns:         Whether the matching is valid and maximal.
+ */
+bool validate_matching(struct graph *g, nid_int (*edges)[2], 
+                       nid_int edges_length) {
+    // Sort the edges with their smallest vertex first, without duplicates.
+    nid_int (*sorted)[2] = malloc((edges_length + 1) * 2 * sizeof(nid_int));
+    nid_int sorted_length = 0;
+
+    for (nid_int i=0; i<edges_length; i++) {
+        nid_int a = edges[i][0];
+        nid_int b = edges[i][1];
+
+        sorted[i][0] = a < b ? a : b;
+        sorted[i][1] = a < b ? b : a;
+    }
+    qsort(sorted, edges_length, 2 * sizeof(nid_int), compare_edges);
+
+    for (nid_int i=0; i<edges_length; i++) {
+        if (sorted_length == 0 || 
+            compare_edges(sorted[sorted_length-1], sorted[i]) != 0) {
+            sorted[sorted_length][0] = sorted[i][0];
+            sorted[sorted_length][1] = sorted[i][1];
+            sorted_length++;
+        }
+    }
+
+    // Report every match to the processes of both its vertices.
+    struct todo_list *todo = get_todo_list();
+
+    for (nid_int i=0; i<g->m->length; i++) {
+        nid_int a = g->m->matches[i][0];
+        nid_int b = g->m->matches[i][1];
+
+        add_instruction(instruction_validate_match(a, b), todo, 
+                        belongs_to_proc(g, a));
+        add_instruction(instruction_validate_match(b, a), todo, 
+                        belongs_to_proc(g, b));
+    }
+
+    struct instruction *response = send_instructions(todo);
+
+    nid_int (*mates)[2] = malloc((todo->expected_responses + 1) * 2 * 
+                                 sizeof(nid_int));
+    nid_int mates_length = 0;
+
+    for (nid_int i=0; i<todo->expected_responses; i++) {
+        if (response[i].value == VALIDATE_MATCH) {
+            mates[mates_length][0] = response[i].content[0];
+            mates[mates_length][1] = response[i].content[1];
+            mates_length++;
+        }
+    }
+    qsort(mates, mates_length, 2 * sizeof(nid_int), compare_edges);
+
+    unallocate_todo_list(todo);
+    free(response);
+
+    // Every vertex may only have one partner, which must be a neighbour.
+    // Both vertices of a match check it, so only the smallest one counts it.
+    nid_int *matched       = malloc((mates_length + 1) * sizeof(nid_int));
+    nid_int *partner       = malloc((mates_length + 1) * sizeof(nid_int));
+    nid_int matched_length = 0;
+    nid_int reused         = 0;
+    nid_int non_edges      = 0;
+
+    for (nid_int i=0; i<mates_length; i++) {
+        nid_int v = mates[i][0];
+        nid_int w = mates[i][1];
+
+        if (matched_length > 0 && matched[matched_length-1] == v) {
+            reused++;
+        } else {
+            matched[matched_length] = v;
+            partner[matched_length] = w;
+            matched_length++;
+        }
+
+        if (v < w && !search_edge(sorted, sorted_length, v, w)) {
+            non_edges++;
+        } else if (v == w) {
+            non_edges++;
+        }
+    }
+
+    nid_int free_edges = count_free_edges(g, sorted, sorted_length, matched, 
+                                          matched_length);
+    nid_int cover      = count_vertex_cover(g, sorted, sorted_length, matched, 
+                                            partner, matched_length);
+
+    // Count the vertices with at least one edge in this process.
+    nid_int active = 0;
+    nid_int *owned = malloc((2 * sorted_length + 1) * sizeof(nid_int));
+
+    for (nid_int i=0; i<sorted_length; i++) {
+        for (short int j=0; j<2; j++) {
+            if (belongs_here(g, sorted[i][j])) {
+                owned[active] = sorted[i][j];
+                active++;
+            }
+        }
+    }
+    active = unique(owned, active);
+
+    nid_int matches = sum_across_processes(g->m->length);
+    reused          = sum_across_processes(reused);
+    non_edges       = sum_across_processes(non_edges);
+    free_edges      = sum_across_processes(free_edges);
+    cover           = sum_across_processes(cover);
+    active          = sum_across_processes(active);
+
+    bool valid = (reused == 0 && non_edges == 0 && free_edges == 0);
+
+    // The vertex cover only covers every edge if the matching is maximal.
+    nid_int bound = active / 2;
+    if (valid && cover < bound) {
+        bound = cover;
+    }
+
+    if (g->pid == 0) {
+        printf("Validated a matching of " NID_FORMAT " edges: " NID_FORMAT
+               " vertices in several matches, " NID_FORMAT " matches that are "
+               "not edges, " NID_FORMAT " edges with two free vertices.\n",
+               matches, reused, non_edges, free_edges);
+        printf("A maximum matching has at most " NID_FORMAT " edges, so this "
+               "matching has at least %.1f%% of its size.\n", 
+               bound, bound == 0 ? 100.0 : 100.0 * matches / bound);
+    }
+
+    free(sorted);
+    free(mates);
+    free(matched);
+    free(partner);
+    free(owned);
+
+    return valid;
+}
+
+/**
+ * Check a matching in shared memory against its graph, and report how far it
+ * can be from a maximum matching.
+ *
+ * This is the counterpart of `validate_matching()` for the shared-memory
+ * backend, and prints the same report.
+ *
+ * Parameters:
+ * - `csr`      Shared graph structure.
+ * - `mate`     The mate of every vertex, or `NO_MATE`.
+ *
+ * Returns:     Whether the matching is valid and maximal.
+ */
+bool validate_mates(const struct csr_graph *csr, nid_int *mate) {
+    nid_int matches    = 0;
+    nid_int reused     = 0;
+    nid_int non_edges  = 0;
+    nid_int free_edges = 0;
+    nid_int cover      = 0;
+    nid_int active     = 0;
+
+    for (nid_int v=0; v<csr->nodes; v++) {
+        nid_int degree = csr->offsets[v+1] - csr->offsets[v];
+        nid_int u      = mate[v];
+
+        if (degree > 0) {
+            active++;
+        }
+
+        if (u == NO_MATE) {
+            // Every free edge is seen from both sides, so count it once.
+            for (nid_int i=csr->offsets[v]; i<csr->offsets[v+1]; i++) {
+                nid_int w = csr->targets[i];
+
+                if (v < w && mate[w] == NO_MATE) {
+                    free_edges++;
+                }
+            }
+            continue;
+        }
+
+        if (u >= csr->nodes || mate[u] != v) {
+            reused++;
+            continue;
+        }
+
+        bool edge = false;
+        for (nid_int i=csr->offsets[v]; i<csr->offsets[v+1]; i++) {
+            edge = edge || (csr->targets[i] == u);
+        }
+        if (!edge || u == v) {
+            non_edges++;
+        }
+
+        if (v < u) {
+            matches++;
+        }
+
+        // A leaf leaves the cover to its partner, unless its partner is a
+        // leaf as well and it is the smallest of the two.
+        nid_int partner_degree = csr->offsets[u+1] - csr->offsets[u];
+
+        if (degree != 1 || (partner_degree == 1 && v < u)) {
+            cover++;
+        }
+    }
+
+    bool valid = (reused == 0 && non_edges == 0 && free_edges == 0);
+
+    // The vertex cover only covers every edge if the matching is maximal.
+    nid_int bound = active / 2;
+    if (valid && cover < bound) {
+        bound = cover;
+    }
+
+    printf("Validated a matching of " NID_FORMAT " edges: " NID_FORMAT
+           " vertices in several matches, " NID_FORMAT " matches that are "
+           "not edges, " NID_FORMAT " edges with two free vertices.\n",
+           matches, reused, non_edges, free_edges);
+    printf("A maximum matching has at most " NID_FORMAT " edges, so this "
+           "matching has at least %.1f%% of its size.\n", 
+           bound, bound == 0 ? 100.0 : 100.0 * matches / bound);
+
+    return valid;
+}
+
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |                 P R I V A T E                |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |               F U N C T I O N S              |
+// |----------------------------------------------|
+// |----------------------------------------------|
+// |----------------------------------------------|
+
+/** PRIVATE
+ * Count the edges of which both vertices are free. A maximal matching has
+ * none.
+ *
+ * Every edge is checked by the process of its smallest vertex. If that vertex
+ * is free, the process asks the process of the other vertex to check it.
+ *
+ * Parameters:
+ * - `g`                Graph structure.
+ * - `edges`            Sorted array of edges, smallest vertex first.
+ * - `edges_length`     Array length of parameter `edges`.
+ * - `matched`          Sorted array of matched vertices in this process.
+ * - `matched_length`   Array length of parameter `matched`.
+ *
+ * Returns:             Amount of free edges that this process found.
+ */
+nid_int count_free_edges(struct graph *g, nid_int (*edges)[2], 
+                         nid_int edges_length, nid_int *matched, 
+                         nid_int matched_length) {
+    struct todo_list *todo = get_todo_list();
+    nid_int free_edges     = 0;
+
+    for (nid_int i=0; i<edges_length; i++) {
+        nid_int u = edges[i][0];
+        nid_int v = edges[i][1];
+
+        if (u == v || !belongs_here(g, u) || 
+            search_sorted(matched, matched_length, u) != matched_length) {
+            continue;
+        }
+
+        if (!belongs_here(g, v)) {
+            add_instruction(instruction_validate_free(v, u), todo, 
+                            belongs_to_proc(g, v));
+        } else if (search_sorted(matched, matched_length, v) == matched_length) {
+            free_edges++;
+        }
+    }
+
+    struct instruction *response = send_instructions(todo);
+
+    for (nid_int i=0; i<todo->expected_responses; i++) {
+        if (response[i].value == VALIDATE_FREE &&
+            search_sorted(matched, matched_length, response[i].content[0]) 
+                == matched_length) {
+            free_edges++;
+        }
+    }
+
+    unallocate_todo_list(todo);
+    free(response);
+
+    return free_edges;
+}
+
+/** PRIVATE
+ * Count the vertices of this process in a vertex cover of the graph.
+ *
+ * If the matching is maximal, its matched vertices cover every edge. A matched
+ * vertex without other neighbours than its partner can leave the cover, as
+ * its partner covers its only edge. If the partner is a leaf as well, only the
+ * smallest of the two stays.
+ *
+ * Parameters:
+ * - `g`                Graph structure.
+ * - `edges`            Sorted array of edges, smallest vertex first.
+ * - `edges_length`     Array length of parameter `edges`.
+ * - `matched`          Sorted array of matched vertices in this process.
+ * - `partner`          Partner of every matched vertex.
+ * - `matched_length`   Array length of parameters `matched` and `partner`.
+ *
+ * Returns:             Amount of vertices of this process in the cover.
+ */
+nid_int count_vertex_cover(struct graph *g, nid_int (*edges)[2], 
+                           nid_int edges_length, nid_int *matched, 
+                           nid_int *partner, nid_int matched_length) {
+    nid_int *degree       = calloc(matched_length + 1, sizeof(nid_int));
+    bool    *partner_leaf = calloc(matched_length + 1, sizeof(bool));
+
+    for (nid_int i=0; i<edges_length; i++) {
+        for (short int j=0; j<2; j++) {
+            nid_int k = search_sorted(matched, matched_length, edges[i][j]);
+
+            if (k != matched_length) {
+                degree[k]++;
+            }
+        }
+    }
+
+    // Tell the partners of all leaves.
+    struct todo_list *todo = get_todo_list();
+
+    for (nid_int k=0; k<matched_length; k++) {
+        if (degree[k] == 1) {
+            add_instruction(instruction_validate_leaf(partner[k], matched[k]),
+                            todo, belongs_to_proc(g, partner[k]));
+        }
+    }
+
+    struct instruction *response = send_instructions(todo);
+
+    for (nid_int i=0; i<todo->expected_responses; i++) {
+        nid_int k = search_sorted(matched, matched_length, 
+                                  response[i].content[0]);
+
+        if (response[i].value == VALIDATE_LEAF && k != matched_length &&
+            partner[k] == response[i].content[1]) {
+            partner_leaf[k] = true;
+        }
+    }
+
+    unallocate_todo_list(todo);
+    free(response);
+
+    nid_int cover = matched_length;
+
+    for (nid_int k=0; k<matched_length; k++) {
+        if (degree[k] == 1 && !(partner_leaf[k] && partner[k] < matched[k])) {
+            cover--;
+        }
+    }
+
+    free(degree);
+    free(partner_leaf);
+
+    return cover;
+}
+
+/** PRIVATE
+ * Check whether a sorted array contains an edge.
+ *
+ * Parameters:
+ * - `edges`            Sorted array of edges, smallest vertex first.
+ * - `edges_length`     Array length of parameter `edges`.
+ * - `a`                Smallest vertex of the edge.
+ * - `b`                Largest vertex of the edge.
+ */
+bool search_edge(nid_int (*edges)[2], nid_int edges_length, nid_int a, 
+                 nid_int b) {
+    nid_int edge[2] = {a, b};
+
+    return bsearch(edge, edges, edges_length, 2 * sizeof(nid_int), 
+                   compare_edges) != NULL;
+}
@@ -0,0 +1,38 @@
+
+/**
+ * Check the matching of all processes against the input graph, and report
+ * how far it can be from a maximum matching.
+ *
+ * The check finds vertices that appear in several matches, matches that are
+ * not edges of the input graph, and edges whose vertices are both free. The
+ * size of a maximum matching is bounded from above by half the amount of
+ * vertices with edges, and by the size of a vertex cover that follows from the
+ * matching if it is maximal.
+ *
+ * Every process needs to call this function, but only PID 0 prints.
+ *
+ * Parameters:
+ * - `g`            Graph structure that holds the matches of this process.
+ * - `edges`        Array of input edges that touch the vertices of this
+ *                  process, as they were received before loading the graph.
+ * - `edges_length` Array length of parameter `edges`.
+ *
+ * Returns:         Whether the matching is valid and maximal.
+ */
+bool validate_matching(struct graph *g, nid_int (*edges)[2], 
+                       nid_int edges_length);
+
+/**
+ * Check a matching in shared memory against its graph, and report how far it
+ * can be from a maximum matching.
+ *
+ * This is the counterpart of `validate_matching()` for the shared-memory
+ * backend, and prints the same report.
+ *
+ * Parameters:
+ * - `csr`      Shared graph structure.
+ * - `mate`     The mate of every vertex, or `NO_MATE`.
+ *
+ * Returns:     Whether the matching is valid and maximal.
+ */
+bool validate_mates(const struct csr_graph *csr, nid_int *mate);